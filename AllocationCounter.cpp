@@ -0,0 +1,72 @@
+/**
+ * @file AllocationCounter.cpp
+ * @author Katarina McGaughy
+ * @brief The AllocationCounter class counts heap allocations per thread
+ * when compiled with -DCOUNT_ALLOCATIONS.
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+using namespace std;
+
+#ifdef COUNT_ALLOCATIONS
+// allocations made by the current thread
+static thread_local long long allocations = 0;
+
+// new[] and the nothrow versions all end up calling this one
+void *operator new(size_t size)
+{
+   allocations++;
+   void *memory = malloc(size == 0 ? 1 : size);
+   if (memory == NULL)
+   {
+      throw bad_alloc();
+   }
+   return memory;
+}
+
+void operator delete(void *memory) noexcept
+{
+   free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+   free(memory);
+}
+#endif
+
+/**
+ * enabled
+ *
+ * @return true : if the program was built with -DCOUNT_ALLOCATIONS
+ */
+bool AllocationCounter::enabled()
+{
+#ifdef COUNT_ALLOCATIONS
+   return true;
+#else
+   return false;
+#endif
+}
+
+/**
+ * threadAllocations
+ *
+ * this function returns how many times operator new has been called on
+ * the calling thread
+ * @return long long : number of allocations made by this thread
+ */
+long long AllocationCounter::threadAllocations()
+{
+#ifdef COUNT_ALLOCATIONS
+   return allocations;
+#else
+   return 0;
+#endif
+}
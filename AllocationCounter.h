@@ -0,0 +1,39 @@
+/**
+ * @file AllocationCounter.h
+ * @author Katarina McGaughy
+ * @brief The AllocationCounter class counts heap allocations so it can be
+ * checked that the solving loop does not allocate. Counting is only done
+ * when AllocationCounter.cpp is compiled with -DCOUNT_ALLOCATIONS, which
+ * replaces the global operator new. Otherwise the counts stay at 0 and
+ * enabled returns false.
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#ifndef ALLOCATIONCOUNTER
+#define ALLOCATIONCOUNTER
+
+class AllocationCounter
+{
+
+public:
+   /**
+    * enabled
+    *
+    * @return true : if the program was built with -DCOUNT_ALLOCATIONS
+    */
+   static bool enabled();
+
+   /**
+    * threadAllocations
+    *
+    * this function returns how many times operator new has been called on
+    * the calling thread. Take the difference of two calls to count the
+    * allocations made by the code between them.
+    * @return long long : number of allocations made by this thread
+    */
+   static long long threadAllocations();
+};
+#endif
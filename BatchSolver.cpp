@@ -0,0 +1,378 @@
+/**
+ * @file BatchSolver.cpp
+ * @author Katarina McGaughy
+ * @brief BatchSolver solves every puzzle in a file on several threads.
+ * Each thread takes one Puzzle from a PuzzlePool and reuses it for all of
+ * its puzzles, and all input and output buffers are allocated before
+ * solving starts, so the solving loop itself does not allocate. When built
+ * with -DCOUNT_ALLOCATIONS the allocations made while solving are counted
+ * and the program fails if there were any.
+ *
+ * usage: BatchSolver <puzzle file> [output file] [threads]
+ *                    [portfolio [threads per puzzle]]
+ * The puzzle file is either the binary format written by PuzzleConverter,
+ * which is decoded straight from memory, or text with one 81 character
+ * puzzle per line, '0' or '.' for empty squares. The output has one line
+ * per puzzle: the solved grid or UNSOLVABLE. With "portfolio" as the
+ * fourth argument every thread solves its puzzles with a PortfolioSolver,
+ * which restarts with shuffled search orders instead of using one fixed
+ * order. It uses one thread per puzzle unless the fifth argument asks for
+ * more, in which case every thread gets that many portfolio threads
+ * counting itself.
+ *
+ * When built with -DSUDOKU_TRACE and the environment variable
+ * SUDOKU_TRACE_FILE is set, the solver phases are traced and written to
+ * $SUDOKU_TRACE_FILE.json (Chrome trace) and $SUDOKU_TRACE_FILE.folded
+ * (folded stacks for flamegraph.pl).
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "AllocationCounter.h"
+#include "PortfolioSolver.h"
+#include "Puzzle.h"
+#include "PuzzleFile.h"
+#include "PuzzlePool.h"
+#include "Trace.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// bytes written per puzzle, 81 characters and a newline
+static const int ANSWER_SIZE = 82;
+
+// nodes in the shortest portfolio run
+static const long long RESTART_BASE = 256;
+
+/**
+ * solveOne
+ *
+ * this function solves a loaded puzzle, with the portfolio if there is one
+ * @param puzzle : the loaded puzzle, holds the solution afterwards
+ * @param portfolio : the thread's portfolio solver, or NULL
+ * @return true : if the puzzle was solved
+ */
+static bool solveOne(Puzzle *puzzle, PortfolioSolver *portfolio)
+{
+   if (portfolio != NULL)
+   {
+      return portfolio->solve(*puzzle);
+   }
+   return puzzle->Solve();
+}
+
+/**
+ * findPuzzles
+ *
+ * this function records where every 81 character line starts
+ * @param contents : the text of the puzzle file
+ * @param offsets : filled with the start of every puzzle
+ * @return int : number of lines that were skipped because they were not
+ * 81 characters long
+ */
+static int findPuzzles(const vector<char> &contents, vector<size_t> &offsets)
+{
+   int skipped = 0;
+   size_t start = 0;
+   while (start < contents.size())
+   {
+      size_t end = start;
+      while (end < contents.size() && contents[end] != '\n')
+      {
+         end++;
+      }
+      size_t length = end - start;
+      if (length > 0 && contents[end - 1] == '\r')
+      {
+         length--;
+      }
+      if (length == 81)
+      {
+         offsets.push_back(start);
+      }
+      else if (length > 0)
+      {
+         skipped++;
+      }
+      start = end + 1;
+   }
+   return skipped;
+}
+
+/**
+ * solveRange
+ *
+ * this function solves puzzles first to last - 1 with one pooled puzzle
+ * and writes each answer into its slot of answers
+ * @param pool : pool the puzzle is taken from
+ * @param contents : the text of the puzzle file
+ * @param offsets : where every puzzle starts
+ * @param first : first puzzle to solve
+ * @param last : one past the last puzzle to solve
+ * @param answers : ANSWER_SIZE bytes for every puzzle
+ * @param portfolioThreads : threads of the PortfolioSolver to solve with,
+ * 0 to solve without one
+ * @param solved : set to the number of puzzles that were solved
+ * @param allocations : set to the allocations made while solving
+ */
+static void solveRange(PuzzlePool *pool, const vector<char> *contents,
+                       const vector<size_t> *offsets, size_t first,
+                       size_t last, char *answers, int portfolioThreads,
+                       long long *solved, long long *allocations)
+{
+   PortfolioSolver portfolio(portfolioThreads, RESTART_BASE,
+                             (unsigned int)first);
+   Trace::prepareThread();
+   long long before = AllocationCounter::threadAllocations();
+   Puzzle *puzzle = pool->acquire();
+   long long count = 0;
+   for (size_t i = first; i < last; i++)
+   {
+      TRACE_SCOPE("puzzle");
+      char *answer = answers + i * ANSWER_SIZE;
+      if (puzzle->load(&(*contents)[(*offsets)[i]]) &&
+          solveOne(puzzle, portfolioThreads > 0 ? &portfolio : NULL))
+      {
+         puzzle->write(answer);
+         answer[81] = '\n';
+         count++;
+      }
+      else
+      {
+         answer[0] = 'U'; // marks the slot as unsolvable
+      }
+   }
+   pool->release(puzzle);
+   *solved = count;
+   *allocations = AllocationCounter::threadAllocations() - before;
+}
+
+/**
+ * solveBlocks
+ *
+ * this function decodes and solves the puzzles of blocks first to
+ * last - 1 of a binary puzzle file with one pooled puzzle and writes each
+ * answer into its slot of answers
+ * @param pool : pool the puzzle is taken from
+ * @param contents : the binary puzzle file
+ * @param blocks : where every block starts
+ * @param first : first block to solve
+ * @param last : one past the last block to solve
+ * @param answers : ANSWER_SIZE bytes for every puzzle
+ * @param portfolioThreads : threads of the PortfolioSolver to solve with,
+ * 0 to solve without one
+ * @param solved : set to the number of puzzles that were solved
+ * @param allocations : set to the allocations made while solving
+ */
+static void solveBlocks(PuzzlePool *pool, const vector<char> *contents,
+                        const vector<PuzzleFile::Block> *blocks, size_t first,
+                        size_t last, char *answers, int portfolioThreads,
+                        long long *solved, long long *allocations)
+{
+   PortfolioSolver portfolio(portfolioThreads, RESTART_BASE,
+                             (unsigned int)first);
+   Trace::prepareThread();
+   long long before = AllocationCounter::threadAllocations();
+   Puzzle *puzzle = pool->acquire();
+   long long count = 0;
+   char numbers[81];
+   for (size_t b = first; b < last; b++)
+   {
+      const PuzzleFile::Block &block = (*blocks)[b];
+      const unsigned char *record =
+          (const unsigned char *)&(*contents)[block.offset];
+      for (unsigned int i = 0; i < block.puzzles; i++)
+      {
+         TRACE_SCOPE("puzzle");
+         char *answer = answers + (block.first + i) * ANSWER_SIZE;
+         record += PuzzleFile::decode(record, numbers);
+         if (puzzle->load(numbers) &&
+             solveOne(puzzle, portfolioThreads > 0 ? &portfolio : NULL))
+         {
+            puzzle->write(answer);
+            answer[81] = '\n';
+            count++;
+         }
+         else
+         {
+            answer[0] = 'U'; // marks the slot as unsolvable
+         }
+      }
+   }
+   pool->release(puzzle);
+   *solved = count;
+   *allocations = AllocationCounter::threadAllocations() - before;
+}
+
+int main(int argc, char *argv[])
+{
+   if (argc < 2)
+   {
+      cerr << "usage: BatchSolver <puzzle file> [output file] [threads] "
+              "[portfolio [threads per puzzle]]"
+           << endl;
+      return 1;
+   }
+   const char *outputPath = argc > 2 ? argv[2] : NULL;
+   int numThreads = argc > 3 ? atoi(argv[3]) : (int)thread::hardware_concurrency();
+   if (numThreads < 1)
+   {
+      numThreads = 1;
+   }
+   int portfolioThreads = 0;
+   if (argc > 4 && string(argv[4]) == "portfolio")
+   {
+      portfolioThreads = argc > 5 ? atoi(argv[5]) : 1;
+      if (portfolioThreads < 1)
+      {
+         portfolioThreads = 1;
+      }
+   }
+
+   const char *tracePath = getenv("SUDOKU_TRACE_FILE");
+   if (tracePath != NULL && !Trace::compiledIn())
+   {
+      cerr << "SUDOKU_TRACE_FILE is ignored: BatchSolver was built without "
+              "-DSUDOKU_TRACE"
+           << endl;
+      tracePath = NULL;
+   }
+   Trace::setEnabled(tracePath != NULL);
+
+   vector<char> contents;
+   vector<size_t> offsets;
+   vector<PuzzleFile::Block> blocks;
+   if (!PuzzleFile::readFile(argv[1], contents))
+   {
+      cerr << "Could not read " << argv[1] << endl;
+      return 1;
+   }
+   bool binary = !contents.empty() &&
+                 PuzzleFile::isBinary(&contents[0], contents.size());
+   size_t count = 0;
+   if (binary)
+   {
+      unsigned long long found;
+      if (!PuzzleFile::findBlocks(&contents[0], contents.size(), blocks, found))
+      {
+         cerr << "The binary puzzle file is corrupt." << endl;
+         return 1;
+      }
+      count = (size_t)found;
+   }
+   else
+   {
+      int skipped = findPuzzles(contents, offsets);
+      if (skipped > 0)
+      {
+         cerr << "Skipped " << skipped << " lines that were not 81 characters."
+              << endl;
+      }
+      count = offsets.size();
+   }
+
+   vector<char> answers(count * ANSWER_SIZE);
+   char *slots = answers.empty() ? NULL : &answers[0];
+   vector<long long> solved(numThreads, 0);
+   vector<long long> allocations(numThreads, 0);
+   vector<thread> workers;
+   PuzzlePool pool(numThreads);
+
+   chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+   size_t nextBlock = 0;
+   for (int t = 0; t < numThreads; t++)
+   {
+      size_t first = count * t / numThreads;
+      size_t last = count * (t + 1) / numThreads;
+      if (binary)
+      {
+         // whole blocks go to a thread, split near the same puzzle counts
+         size_t firstBlock = nextBlock;
+         while (nextBlock < blocks.size() &&
+                (t == numThreads - 1 || blocks[nextBlock].first < last))
+         {
+            nextBlock++;
+         }
+         workers.push_back(thread(solveBlocks, &pool, &contents, &blocks,
+                                  firstBlock, nextBlock, slots, portfolioThreads,
+                                  &solved[t], &allocations[t]));
+      }
+      else
+      {
+         workers.push_back(thread(solveRange, &pool, &contents, &offsets,
+                                  first, last, slots, portfolioThreads,
+                                  &solved[t], &allocations[t]));
+      }
+   }
+   long long totalSolved = 0;
+   long long totalAllocations = 0;
+   for (int t = 0; t < numThreads; t++)
+   {
+      workers[t].join();
+      totalSolved += solved[t];
+      totalAllocations += allocations[t];
+   }
+   double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin)
+                        .count();
+
+   if (outputPath != NULL)
+   {
+      FILE *output = fopen(outputPath, "wb");
+      if (output == NULL)
+      {
+         cerr << "Could not write " << outputPath << endl;
+         return 1;
+      }
+      for (size_t i = 0; i < count; i++)
+      {
+         const char *answer = &answers[i * ANSWER_SIZE];
+         if (answer[0] == 'U')
+         {
+            fputs("UNSOLVABLE\n", output);
+         }
+         else
+         {
+            fwrite(answer, 1, ANSWER_SIZE, output);
+         }
+      }
+      fclose(output);
+   }
+
+   if (tracePath != NULL)
+   {
+      Trace::setEnabled(false);
+      string prefix = tracePath;
+      if (!Trace::writeChromeJson((prefix + ".json").c_str()) ||
+          !Trace::writeFolded((prefix + ".folded").c_str()))
+      {
+         cerr << "Could not write the trace to " << prefix << endl;
+      }
+      else if (Trace::droppedEvents() > 0)
+      {
+         cerr << "trace:      " << Trace::droppedEvents()
+              << " oldest events dropped from " << prefix
+              << ".json, the folded stacks cover the whole run" << endl;
+      }
+   }
+
+   cerr << "puzzles:    " << count << " (" << totalSolved << " solved)" << endl;
+   cerr << "seconds:    " << seconds << endl;
+   cerr << "throughput: " << (seconds > 0 ? count / seconds : 0)
+        << " puzzles/s" << endl;
+   if (AllocationCounter::enabled())
+   {
+      cerr << "heap allocations while solving: " << totalAllocations << endl;
+      if (totalAllocations != 0)
+      {
+         return 2;
+      }
+   }
+   return 0;
+}
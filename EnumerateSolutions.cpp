@@ -0,0 +1,141 @@
+/**
+ * @file EnumerateSolutions.cpp
+ * @author Katarina McGaughy
+ * @brief EnumerateSolutions finds every solution of one puzzle, or the
+ * first limit of them, and reports how many there were, how fast they
+ * were found, and how many different values each square takes across
+ * the solutions. The solutions can also be written to a binary puzzle
+ * file, which PuzzleConverter turns back into text.
+ *
+ * usage: EnumerateSolutions <81 character puzzle> [threads] [limit]
+ *                           [output file]
+ * A limit of 0 finds every solution.
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "Puzzle.h"
+#include "PuzzleFile.h"
+#include "SolutionEnumerator.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+using namespace std;
+
+// what the sink collects
+struct Collected
+{
+   // solutions are written here if it is not NULL
+   PuzzleFile *file;
+   // how often every value appears in every square
+   unsigned long long counts[81][10];
+   // whether every solution was written
+   bool written;
+};
+
+/**
+ * collect
+ *
+ * the sink for SolutionEnumerator: counts the values of every square and
+ * writes the solutions to the output file
+ * @param grids : count solutions of 81 characters
+ * @param count : number of solutions in grids
+ * @param context : the Collected to fill in
+ */
+static void collect(const char *grids, size_t count, void *context)
+{
+   Collected *collected = (Collected *)context;
+   for (size_t i = 0; i < count; i++)
+   {
+      const char *grid = grids + i * 81;
+      for (int square = 0; square < 81; square++)
+      {
+         collected->counts[square][grid[square] - '0']++;
+      }
+      if (collected->file != NULL && !collected->file->add(grid))
+      {
+         collected->written = false;
+      }
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   if (argc < 2 || strlen(argv[1]) != 81)
+   {
+      cerr << "usage: EnumerateSolutions <81 character puzzle> [threads] "
+              "[limit] [output file]"
+           << endl;
+      return 1;
+   }
+   int numThreads = argc > 2 ? atoi(argv[2]) : (int)thread::hardware_concurrency();
+   unsigned long long limit = argc > 3 ? strtoull(argv[3], NULL, 10) : 0;
+   const char *outputPath = argc > 4 ? argv[4] : NULL;
+
+   Puzzle puzzle;
+   if (!puzzle.load(argv[1]))
+   {
+      cerr << "The puzzle may only hold digits and '.'" << endl;
+      return 1;
+   }
+
+   PuzzleFile file;
+   Collected collected = Collected();
+   collected.file = NULL;
+   collected.written = true;
+   if (outputPath != NULL)
+   {
+      if (!file.create(outputPath, 4096))
+      {
+         cerr << "Could not write " << outputPath << endl;
+         return 1;
+      }
+      collected.file = &file;
+   }
+
+   SolutionEnumerator enumerator(numThreads, limit);
+   unsigned long long found = enumerator.enumerate(puzzle, collect, &collected);
+   double seconds = enumerator.seconds();
+   bool written = outputPath == NULL || (file.close() && collected.written);
+   if (!written)
+   {
+      cerr << "Could not write " << outputPath << endl;
+   }
+
+   cout << "solutions:   " << found
+        << (enumerator.limitReached() ? " (stopped at the limit)" : "") << endl;
+   cout << "subproblems: " << enumerator.subproblems() << endl;
+   cout << "seconds:     " << seconds << endl;
+   cout << "throughput:  " << (seconds > 0 ? found / seconds : 0)
+        << " solutions/s" << endl;
+
+   if (found > 0)
+   {
+      // how many different values every square takes across the solutions
+      int forced = 0;
+      cout << "values per square:" << endl;
+      for (int row = 0; row < 9; row++)
+      {
+         for (int col = 0; col < 9; col++)
+         {
+            int distinct = 0;
+            for (int value = 1; value <= 9; value++)
+            {
+               distinct += collected.counts[row * 9 + col][value] > 0;
+            }
+            forced += distinct == 1;
+            cout << distinct << (col == 2 || col == 5 ? "|" : col == 8 ? "\n" : " ");
+         }
+         if (row == 2 || row == 5)
+         {
+            cout << "-----+-----+-----" << endl;
+         }
+      }
+      cout << "squares with the same value in every solution: " << forced
+           << endl;
+   }
+   return written ? 0 : 1;
+}
@@ -0,0 +1,260 @@
+/**
+ * @file LoadClient.cpp
+ * @author Katarina McGaughy
+ * @brief LoadClient sends puzzles to a running SolverDaemon from several
+ * connections at once and reports the throughput and the latency
+ * percentiles it saw, so the daemon can be measured under load on one
+ * machine.
+ *
+ * usage: LoadClient <puzzle file> [socket path] [connections]
+ *                   [requests per connection] [pipeline depth]
+ * The puzzle file holds one 81 character puzzle per line. Puzzles are
+ * reused from the start of the file when it runs out.
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+using namespace std;
+
+/**
+ * connectTo
+ *
+ * this function opens a connection to the daemon
+ * @param socketPath : path of the daemon's Unix domain socket
+ * @return int : connected socket, or -1 on failure
+ */
+static int connectTo(const string &socketPath)
+{
+   sockaddr_un address;
+   memset(&address, 0, sizeof(address));
+   address.sun_family = AF_UNIX;
+   strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+   int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (fd < 0 || connect(fd, (sockaddr *)&address, sizeof(address)) < 0)
+   {
+      if (fd >= 0)
+      {
+         close(fd);
+      }
+      return -1;
+   }
+   return fd;
+}
+
+/**
+ * readLines
+ *
+ * this function reads from the socket until the wanted number of lines
+ * has arrived. Extra bytes are kept in buffer for the next call.
+ * @param fd : connected socket
+ * @param buffer : bytes read but not yet returned
+ * @param wanted : number of lines to read
+ * @param lines : the lines read, without newlines
+ * @param arrivals : if not NULL, set to the time every line arrived
+ * @return true : if all lines were read
+ */
+static bool readLines(int fd, string &buffer, int wanted, vector<string> &lines,
+                      vector<chrono::steady_clock::time_point> *arrivals)
+{
+   char chunk[8192];
+   // lines already in buffer arrived before this call
+   chrono::steady_clock::time_point arrived = chrono::steady_clock::now();
+   lines.clear();
+   if (arrivals != NULL)
+   {
+      arrivals->clear();
+   }
+   while ((int)lines.size() < wanted)
+   {
+      size_t newline = buffer.find('\n');
+      if (newline != string::npos)
+      {
+         lines.push_back(buffer.substr(0, newline));
+         buffer.erase(0, newline + 1);
+         if (arrivals != NULL)
+         {
+            arrivals->push_back(arrived);
+         }
+         continue;
+      }
+      ssize_t count = read(fd, chunk, sizeof(chunk));
+      if (count <= 0)
+      {
+         return false;
+      }
+      arrived = chrono::steady_clock::now();
+      buffer.append(chunk, count);
+   }
+   return true;
+}
+
+/**
+ * sendAll
+ *
+ * @param fd : connected socket
+ * @param data : bytes to send
+ * @return true : if everything was sent
+ */
+static bool sendAll(int fd, const string &data)
+{
+   size_t sent = 0;
+   while (sent < data.length())
+   {
+      ssize_t wrote = send(fd, data.data() + sent, data.length() - sent,
+                           MSG_NOSIGNAL);
+      if (wrote <= 0)
+      {
+         return false;
+      }
+      sent += wrote;
+   }
+   return true;
+}
+
+int main(int argc, char *argv[])
+{
+   if (argc < 2)
+   {
+      cerr << "usage: LoadClient <puzzle file> [socket path] [connections] "
+              "[requests per connection] [pipeline depth]"
+           << endl;
+      return 1;
+   }
+   string socketPath = argc > 2 ? argv[2] : "/tmp/sudoku.sock";
+   int connections = argc > 3 ? atoi(argv[3]) : 4;
+   int perConnection = argc > 4 ? atoi(argv[4]) : 10000;
+   int depth = argc > 5 ? atoi(argv[5]) : 16;
+   if (connections < 1 || perConnection < 1 || depth < 1)
+   {
+      cerr << "Counts must be positive." << endl;
+      return 1;
+   }
+
+   vector<string> puzzles;
+   ifstream file(argv[1]);
+   string line;
+   while (getline(file, line))
+   {
+      if (!line.empty() && line[line.length() - 1] == '\r')
+      {
+         line.erase(line.length() - 1);
+      }
+      if (line.length() == 81)
+      {
+         puzzles.push_back(line);
+      }
+   }
+   if (puzzles.empty())
+   {
+      cerr << "No 81 character puzzles found in " << argv[1] << endl;
+      return 1;
+   }
+
+   vector<vector<long long> > latencies(connections);
+   vector<int> failures(connections, 0);
+   vector<thread> clients;
+   chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+
+   for (int c = 0; c < connections; c++)
+   {
+      clients.push_back(thread([&, c]() {
+         int fd = connectTo(socketPath);
+         if (fd < 0)
+         {
+            failures[c] = perConnection;
+            return;
+         }
+         latencies[c].reserve(perConnection);
+         string buffer;
+         string request;
+         vector<string> replies;
+         vector<chrono::steady_clock::time_point> arrivals;
+         size_t next = (size_t)c * perConnection;
+         for (int done = 0; done < perConnection;)
+         {
+            int count = min(depth, perConnection - done);
+            request.clear();
+            for (int i = 0; i < count; i++)
+            {
+               request += puzzles[next++ % puzzles.size()];
+               request += '\n';
+            }
+            chrono::steady_clock::time_point sentAt = chrono::steady_clock::now();
+            if (!sendAll(fd, request) ||
+                !readLines(fd, buffer, count, replies, &arrivals))
+            {
+               failures[c] += perConnection - done;
+               break;
+            }
+            for (int i = 0; i < count; i++)
+            {
+               if (replies[i].compare(0, 5, "ERROR") == 0)
+               {
+                  failures[c]++;
+               }
+               // each reply is timed from the send to its own arrival
+               latencies[c].push_back(
+                   chrono::duration_cast<chrono::microseconds>(arrivals[i] - sentAt)
+                       .count());
+            }
+            done += count;
+         }
+         close(fd);
+      }));
+   }
+   for (size_t c = 0; c < clients.size(); c++)
+   {
+      clients[c].join();
+   }
+   double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin)
+                        .count();
+
+   vector<long long> all;
+   int failed = 0;
+   for (int c = 0; c < connections; c++)
+   {
+      all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+      failed += failures[c];
+   }
+   sort(all.begin(), all.end());
+
+   cout << "requests:   " << all.size() << " (" << failed << " failed)" << endl;
+   cout << "seconds:    " << seconds << endl;
+   cout << "throughput: " << (seconds > 0 ? all.size() / seconds : 0)
+        << " puzzles/s" << endl;
+   if (!all.empty())
+   {
+      cout << "p50 us:     " << all[all.size() * 50 / 100] << endl;
+      cout << "p90 us:     " << all[all.size() * 90 / 100] << endl;
+      cout << "p99 us:     " << all[all.size() * 99 / 100] << endl;
+      cout << "max us:     " << all.back() << endl;
+   }
+
+   // the daemon's own counters, measured from queue to solved
+   int fd = connectTo(socketPath);
+   vector<string> stats;
+   string buffer;
+   if (fd >= 0 && sendAll(fd, "STATS\n") && readLines(fd, buffer, 1, stats, NULL))
+   {
+      cout << stats[0] << endl;
+   }
+   if (fd >= 0)
+   {
+      close(fd);
+   }
+   return failed == 0 ? 0 : 1;
+}
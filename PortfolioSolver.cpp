@@ -0,0 +1,237 @@
+/**
+ * @file PortfolioSolver.cpp
+ * @author Katarina McGaughy
+ * @brief The PortfolioSolver class solves one puzzle with several search
+ * orders at once, restarting runs on a Luby schedule, and keeps the first
+ * answer.
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "PortfolioSolver.h"
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+using namespace std;
+
+/**
+ * PortfolioSolver
+ *
+ * constructor
+ * @param numThreads : number of threads searching at once
+ * @param restartBase : nodes in the shortest run
+ * @param seed : seed for shuffling the orders
+ */
+PortfolioSolver::PortfolioSolver(int numThreads, long long restartBase,
+                                 unsigned int seed)
+    : numThreads(numThreads < 1 ? 1 : numThreads),
+      restartBase(restartBase < 1 ? 1 : restartBase), seed(seed),
+      finished(false), runCount(0), work(this->numThreads), winner(0),
+      solved(false), start(NULL), generation(0), running(0), quitting(false)
+{
+   for (int strategy = 1; strategy < this->numThreads; strategy++)
+   {
+      helpers.push_back(thread(&PortfolioSolver::helperLoop, this, strategy));
+   }
+}
+
+/**
+ * ~PortfolioSolver
+ *
+ * destructor, stops the helper threads
+ */
+PortfolioSolver::~PortfolioSolver()
+{
+   {
+      lock_guard<mutex> lock(helperLock);
+      quitting = true;
+   }
+   helperWake.notify_all();
+   for (size_t i = 0; i < helpers.size(); i++)
+   {
+      helpers[i].join();
+   }
+}
+
+/**
+ * solve
+ *
+ * this function solves the puzzle with every strategy and stops all of
+ * them once one has finished
+ * @param puzzle : the loaded puzzle, holds the solution afterwards
+ * @return true : if the puzzle was solved
+ * @return false : if the puzzle does not have a solution
+ */
+bool PortfolioSolver::solve(Puzzle &puzzle)
+{
+   finished = false;
+   runCount = 0;
+   solved = false;
+
+   if (numThreads == 1)
+   {
+      search(&puzzle, 0, false, &solved);
+   }
+   else
+   {
+      {
+         lock_guard<mutex> lock(helperLock);
+         start = &puzzle;
+         running = numThreads - 1;
+         generation++;
+      }
+      helperWake.notify_all();
+      search(&puzzle, 0, true, &solved);
+      unique_lock<mutex> lock(helperLock);
+      helpersIdle.wait(lock, [this]() { return running == 0; });
+   }
+
+   if (solved)
+   {
+      puzzle = work[winner];
+      puzzle.setOrder(NULL, NULL);
+      puzzle.setLimit(0, NULL);
+   }
+   return solved;
+}
+
+/**
+ * helperLoop
+ *
+ * this function is run by every helper thread. It waits for a solve to
+ * start, runs its strategy until some strategy finishes and waits again.
+ * @param strategy : the strategy of this thread, at least 1
+ */
+void PortfolioSolver::helperLoop(int strategy)
+{
+   unsigned long long seen = 0;
+   unique_lock<mutex> lock(helperLock);
+   while (true)
+   {
+      helperWake.wait(lock, [this, seen]() {
+         return quitting || generation != seen;
+      });
+      if (quitting)
+      {
+         return;
+      }
+      seen = generation;
+      const Puzzle *puzzle = start;
+      lock.unlock();
+
+      search(puzzle, strategy, false, &solved);
+
+      lock.lock();
+      running--;
+      if (running == 0)
+      {
+         helpersIdle.notify_one();
+      }
+   }
+}
+
+/**
+ * runs
+ *
+ * @return long long : number of runs started by the last solve
+ */
+long long PortfolioSolver::runs()
+{
+   return runCount;
+}
+
+/**
+ * luby
+ *
+ * this function returns the i-th term of the Luby sequence. If i is
+ * 2^k - 1 the term is 2^(k-1), otherwise the sequence repeats itself from
+ * the start after each 2^(k-1) - 1 terms.
+ * PRE: i must be at least 1.
+ * @param i : position in the sequence
+ * @return long long : the term
+ */
+long long PortfolioSolver::luby(long long i)
+{
+   while (true)
+   {
+      int k = 1;
+      while ((1LL << k) - 1 < i)
+      {
+         k++;
+      }
+      if ((1LL << k) - 1 == i)
+      {
+         return 1LL << (k - 1);
+      }
+      i -= (1LL << (k - 1)) - 1;
+   }
+}
+
+/**
+ * search
+ *
+ * this function runs one strategy until it or another strategy
+ * finishes. A run that ends without reaching its limit has either solved
+ * the puzzle or shown it has no solution, so the first such run decides
+ * the outcome.
+ * @param start : the puzzle as loaded
+ * @param strategy : which strategy, 0 starts with the normal order
+ * @param unlimited : true to run strategy 0 without restarts
+ * @param solved : set to whether the winner solved the puzzle
+ */
+void PortfolioSolver::search(const Puzzle *start, int strategy, bool unlimited,
+                             bool *solved)
+{
+   Puzzle &work = this->work[strategy];
+   work = *start;
+   mt19937 random(seed + 7919u * strategy);
+   int values[9];
+   int rows[9];
+   int cols[9];
+   int squares[81];
+   for (int i = 0; i < 9; i++)
+   {
+      values[i] = i + 1;
+      rows[i] = i;
+      cols[i] = i;
+   }
+
+   for (long long run = 1; !finished; run++)
+   {
+      if (strategy == 0 && run == 1)
+      {
+         work.setOrder(NULL, NULL);
+      }
+      else
+      {
+         shuffle(values, values + 9, random);
+         shuffle(rows, rows + 9, random);
+         shuffle(cols, cols + 9, random);
+         for (int r = 0; r < 9; r++)
+         {
+            for (int c = 0; c < 9; c++)
+            {
+               squares[r * 9 + c] = rows[r] * 9 + cols[c];
+            }
+         }
+         work.setOrder(values, squares);
+      }
+      work.setLimit(unlimited ? 0 : restartBase * luby(run), &finished);
+      runCount++;
+
+      bool done = work.Solve();
+      if (!work.limitReached())
+      {
+         bool expected = false;
+         if (finished.compare_exchange_strong(expected, true))
+         {
+            *solved = done;
+            winner = strategy;
+         }
+         return;
+      }
+   }
+}
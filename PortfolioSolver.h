@@ -0,0 +1,165 @@
+/**
+ * @file PortfolioSolver.h
+ * @author Katarina McGaughy
+ * @brief The PortfolioSolver class solves one puzzle with several search
+ * orders at once and keeps the first answer. Backtracking with one fixed
+ * order is very slow on some puzzles that another order solves quickly,
+ * so trying several orders and restarting the ones that take too long
+ * cuts the worst case time.
+ *
+ * Strategy 0 starts with the normal order (1 to 9, row by row). Every
+ * other run shuffles the value order and the order of the rows and of the
+ * columns. Runs are cut off after restartBase * luby(run) nodes, so most
+ * runs are short but some are long enough for any puzzle. With one thread
+ * only strategy 0 runs, on the calling thread: its first run uses the
+ * normal order and every restart a new shuffled order. With more threads
+ * strategy 0 keeps the normal order without a limit on the calling thread
+ * and every other strategy runs shuffled orders with restarts on its own
+ * helper thread. The helper threads are started by the constructor and
+ * wait between solves, so a solve does not start any threads.
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "Puzzle.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifndef PORTFOLIOSOLVER
+#define PORTFOLIOSOLVER
+using namespace std;
+
+class PortfolioSolver
+{
+
+public:
+   /**
+    * PortfolioSolver
+    *
+    * constructor
+    * @param numThreads : number of threads searching at once, 1 to
+    * interleave the orders on the calling thread
+    * @param restartBase : nodes in the shortest run
+    * @param seed : seed for shuffling the orders, the same seed gives the
+    * same orders
+    */
+   PortfolioSolver(int numThreads, long long restartBase, unsigned int seed);
+
+   /**
+    * ~PortfolioSolver
+    *
+    * destructor, stops the helper threads
+    */
+   ~PortfolioSolver();
+
+   /**
+    * solve
+    *
+    * this function solves the puzzle with every strategy and stops all of
+    * them once one has finished
+    * @param puzzle : the loaded puzzle, holds the solution afterwards
+    * @return true : if the puzzle was solved
+    * @return false : if the puzzle does not have a solution
+    */
+   bool solve(Puzzle &puzzle);
+
+   /**
+    * runs
+    *
+    * @return long long : number of runs started by the last solve,
+    * counting every restart
+    */
+   long long runs();
+
+   /**
+    * luby
+    *
+    * this function returns the i-th term of the Luby sequence
+    * 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ...
+    * PRE: i must be at least 1.
+    * @param i : position in the sequence
+    * @return long long : the term
+    */
+   static long long luby(long long i);
+
+private:
+   // threads searching at once
+   int numThreads;
+
+   // nodes in the shortest run
+   long long restartBase;
+
+   // seed for shuffling the orders
+   unsigned int seed;
+
+   // set by the first strategy to finish, makes the others give up
+   atomic<bool> finished;
+
+   // runs started by the current solve
+   atomic<long long> runCount;
+
+   // the puzzle every strategy works on, made once and copied into by
+   // each solve
+   vector<Puzzle> work;
+
+   // strategy whose puzzle holds the solution
+   int winner;
+
+   // whether the winner solved the puzzle
+   bool solved;
+
+   // threads running strategies 1 to numThreads - 1
+   vector<thread> helpers;
+
+   // puzzle of the current solve, read by the helpers
+   const Puzzle *start;
+
+   // counts the solves, a helper starts when it changes
+   unsigned long long generation;
+
+   // helpers still searching in the current solve
+   int running;
+
+   // set by the destructor to make the helpers exit
+   bool quitting;
+
+   // guards start, generation, running and quitting
+   mutex helperLock;
+
+   // signalled when a solve starts or the helpers must exit
+   condition_variable helperWake;
+
+   // signalled when the last helper of a solve is done
+   condition_variable helpersIdle;
+
+   // the helper threads make a solver impossible to copy
+   PortfolioSolver(const PortfolioSolver &);
+   PortfolioSolver &operator=(const PortfolioSolver &);
+
+   /**
+    * helperLoop
+    *
+    * this function is run by every helper thread. It runs one strategy
+    * for every solve until the solver is destroyed.
+    * @param strategy : the strategy of this thread, at least 1
+    */
+   void helperLoop(int strategy);
+
+   /**
+    * search
+    *
+    * this function runs one strategy until it or another strategy
+    * finishes. The first strategy to finish writes the outcome.
+    * @param start : the puzzle as loaded
+    * @param strategy : which strategy, 0 starts with the normal order
+    * @param unlimited : true to run strategy 0 without restarts
+    * @param solved : set to whether the winner solved the puzzle
+    */
+   void search(const Puzzle *start, int strategy, bool unlimited,
+               bool *solved);
+};
+#endif
@@ -0,0 +1,118 @@
+/**
+ * @file PortfolioSolverTester.cpp
+ * @author Katarina McGaughy
+ * @brief PortfolioSolverTester performs tests on the PortfolioSolver class
+ * by solving the same puzzles with one thread and with several, checking
+ * every answer, and by checking the Luby sequence the restarts follow
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "PortfolioSolver.h"
+#include "Puzzle.h"
+#include <iostream>
+#include <string>
+using namespace std;
+
+/**
+ * validSolution
+ *
+ * this function checks that a puzzle holds a full grid that keeps the
+ * givens of the puzzle it was loaded from
+ * @param puzzle : the solved puzzle
+ * @param givens : the 81 character puzzle it was loaded from
+ * @return true : if every row, column and box holds 1-9 once
+ */
+static bool validSolution(Puzzle &puzzle, const string &givens)
+{
+   // bit v of a row, column or box is set once value v was seen in it
+   int rows[9] = {0};
+   int cols[9] = {0};
+   int boxes[9] = {0};
+   for (int square = 0; square < 81; square++)
+   {
+      int row = square / 9;
+      int col = square % 9;
+      int value = puzzle.get(row, col);
+      char given = givens[square];
+      if (value < 1 || value > 9 ||
+          (given != '0' && given != '.' && given - '0' != value))
+      {
+         return false;
+      }
+      rows[row] |= 1 << value;
+      cols[col] |= 1 << value;
+      boxes[row / 3 * 3 + col / 3] |= 1 << value;
+   }
+   for (int unit = 0; unit < 9; unit++)
+   {
+      if (rows[unit] != 0x3FE || cols[unit] != 0x3FE || boxes[unit] != 0x3FE)
+      {
+         return false;
+      }
+   }
+   return true;
+}
+
+int main()
+{
+   string puzzles[4] = {
+       "530070000600195000098000060800060003400803001700020006060000280000419005000080079",
+       "..9748...7.........2.1.9.....7...24..64.1.59..98...3.....8.3.2.........6...2759..",
+       "000000000000000000000000000859761423426853791713924856961537284287419635345286179",
+       "100007090030020008009600500005300900010080002600004000300000010040000007007000300"};
+   // the 9 that square 0 needs is already in its box
+   string unsolvable =
+       "012345678900000000000000000000000000000000000000000000000000000000000000000000000";
+   int failures = 0;
+
+   long long expected[15] = {1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8};
+   for (int i = 0; i < 15; i++)
+   {
+      if (PortfolioSolver::luby(i + 1) != expected[i])
+      {
+         cout << "luby(" << i + 1 << ") is " << PortfolioSolver::luby(i + 1)
+              << ", expected " << expected[i] << "." << endl;
+         failures++;
+      }
+   }
+
+   // the same solvers are reused for every puzzle, twice over, so the
+   // helper threads of the concurrent one wait between solves
+   int threadCounts[2] = {1, 3};
+   for (int t = 0; t < 2; t++)
+   {
+      PortfolioSolver portfolio(threadCounts[t], 64, 1);
+      for (int round = 0; round < 2; round++)
+      {
+         for (int i = 0; i < 4; i++)
+         {
+            Puzzle puzzle;
+            puzzle.load(puzzles[i].c_str());
+            if (!portfolio.solve(puzzle) || !validSolution(puzzle, puzzles[i]) ||
+                portfolio.runs() < 1)
+            {
+               cout << "Puzzle " << i << " was not solved with "
+                    << threadCounts[t] << " threads." << endl;
+               failures++;
+            }
+         }
+         Puzzle puzzle;
+         puzzle.load(unsolvable.c_str());
+         if (portfolio.solve(puzzle))
+         {
+            cout << "An unsolvable puzzle was solved with " << threadCounts[t]
+                 << " threads." << endl;
+            failures++;
+         }
+      }
+   }
+
+   if (failures == 0)
+   {
+      cout << "All PortfolioSolver tests passed." << endl;
+   }
+   return failures == 0 ? 0 : 1;
+}
@@ -12,6 +12,7 @@
  * 
  */
 #include "Puzzle.h"
+#include "Trace.h"
 #include <iostream>
 #include <string>
 using namespace std;
@@ -20,10 +21,12 @@ using namespace std;
  * Puzzle
  *
  * constructor initializes numberOfEmtyVars to 0 and
- * numberOfVariables to 0
+ * numberOfVariables to 0. Solve uses the default order and no limits.
  */
-Puzzle::Puzzle() : numberOfEmptyVars(0), numberOfVariables(0), puzzleGrid()
+Puzzle::Puzzle() : numberOfVariables(0), numberOfEmptyVars(0), puzzleGrid(),
+                   maxNodes(0), nodeCount(0), stop(NULL), gaveUp(false)
 {
+   setOrder(NULL, NULL);
 }
 
 /**
@@ -49,14 +52,14 @@ Puzzle::~Puzzle()
  */
 bool Puzzle::findNextEmpty(int &row, int &col)
 {
-   for (row = 0; row < 9; row++)
+   TRACE_SCOPE("findNextEmpty");
+   for (int i = 0; i < 81; i++)
    {
-      for (col = 0; col < 9; col++)
-      {
-         if (get(row, col) == 0)
-         {               // marked with 0 is empty
-            return true; // returns col and row
-         }
+      row = squareOrder[i] / 9;
+      col = squareOrder[i] % 9;
+      if (get(row, col) == 0)
+      {               // marked with 0 is empty
+         return true; // returns col and row
       }
    }
    return false;
@@ -71,17 +74,30 @@ bool Puzzle::findNextEmpty(int &row, int &col)
  * work.
  * PRE: the row and collumn must be between 0 and 8.
  * @return true : if the puzzle is solved
- * @return false : false if the puzzle does not have a solution
+ * @return false : false if the puzzle does not have a solution, or if
+ * the search gave up because of setLimit (see limitReached)
  */
 bool Puzzle::Solve()
 {
    int row, col;
+   if (gaveUp)
+   {
+      return false; // unwinding after a limit was reached
+   }
+   nodeCount++;
+   if ((maxNodes > 0 && nodeCount > maxNodes) ||
+       (stop != NULL && stop->load(memory_order_relaxed)))
+   {
+      gaveUp = true;
+      return false;
+   }
    if (!findNextEmpty(row, col))
    {
       return true; // at end of puzzle
    }
-   for (int value = 1; value <= 9; value++)
+   for (int i = 0; i < 9 && !gaveUp; i++)
    {
+      int value = valueOrder[i];
       if (set(row, col, value))
       {
          numberOfEmptyVars--;
@@ -90,6 +106,7 @@ bool Puzzle::Solve()
          {
             return true;
          }
+         TRACE_SCOPE("undo");
          puzzleGrid[row][col].setValue(0);
          numberOfEmptyVars++;
          puzzleGrid[row][col].setFixed(false);
@@ -180,6 +197,7 @@ int Puzzle::numEmpty()
  */
 bool Puzzle::isSafe(int row, int col, int value)
 {
+   TRACE_SCOPE("isSafe");
    // if the square is not empty return false
    if (!isVariableEmpty(row, col))
    {
@@ -220,6 +238,7 @@ bool Puzzle::isSafe(int row, int col, int value)
  */
 bool Puzzle::numberInBox(int row, int col, int value)
 {
+   TRACE_SCOPE("numberInBox");
    int boxStartRow = -1;
    int boxStartCol = -1;
    int boxEndRow = -1;
@@ -244,7 +263,7 @@ bool Puzzle::numberInBox(int row, int col, int value)
       boxStartCol = 0;
       boxEndCol = 3;
    }
-   else if (col >= 0 && col < 3)
+   else if (col >= 3 && col < 6)
    {
       boxStartCol = 3;
       boxEndCol = 6;
@@ -252,7 +271,7 @@ bool Puzzle::numberInBox(int row, int col, int value)
    else
    {
       boxStartCol = 6;
-      boxStartCol = 9;
+      boxEndCol = 9;
    }
 
    for (int y = boxStartCol; y < boxEndCol; y++){
@@ -277,6 +296,7 @@ bool Puzzle::numberInBox(int row, int col, int value)
  */
 bool Puzzle::numberInRow(int row, int value)
 {
+   TRACE_SCOPE("numberInRow");
    for (int col = 0; col < 9; col++)
       if (get(row, col) == value)
          return true;
@@ -296,6 +316,7 @@ bool Puzzle::numberInRow(int row, int value)
  */
 bool Puzzle::numberInCol(int col, int value)
 {
+   TRACE_SCOPE("numberInCol");
    for (int row = 0; row < 9; row++)
       if (get(row, col) == value)
          return true;
@@ -402,6 +423,132 @@ istream &operator>>(istream &in, Puzzle &puzzle)
    return in;
 }
 
+/**
+ * setOrder
+ *
+ * this function sets the order Solve tries the values in and the order
+ * it fills the empty squares in
+ * PRE: values must hold 1-9 once each and squares must hold 0-80
+ * (row * 9 + col) once each.
+ * @param values : the 9 values in the order they are tried, or NULL
+ * for 1 to 9
+ * @param squares : the 81 squares in the order they are filled, or
+ * NULL for row by row
+ */
+void Puzzle::setOrder(const int *values, const int *squares)
+{
+   for (int i = 0; i < 9; i++)
+   {
+      valueOrder[i] = (values != NULL) ? values[i] : i + 1;
+   }
+   for (int i = 0; i < 81; i++)
+   {
+      squareOrder[i] = (squares != NULL) ? squares[i] : i;
+   }
+}
+
+/**
+ * setLimit
+ *
+ * this function limits how much searching Solve may do before it gives
+ * up, and resets the count of nodes searched
+ * @param maxNodes : most calls to Solve before giving up, 0 for no limit
+ * @param stop : Solve gives up once *stop is true, NULL to ignore
+ */
+void Puzzle::setLimit(long long maxNodes, const atomic<bool> *stop)
+{
+   this->maxNodes = maxNodes;
+   this->stop = stop;
+   nodeCount = 0;
+   gaveUp = false;
+}
+
+/**
+ * limitReached
+ *
+ * @return true : if the last Solve gave up because of setLimit
+ */
+bool Puzzle::limitReached()
+{
+   return gaveUp;
+}
+
+/**
+ * nodes
+ *
+ * @return long long : calls to Solve since the last load or setLimit
+ */
+long long Puzzle::nodes()
+{
+   return nodeCount;
+}
+
+/**
+ * load
+ *
+ * this function resets the puzzle and initializes the squares from 81
+ * characters in row-major order. '0' or '.' marks an empty square.
+ * PRE: numbers must point to at least 81 characters.
+ * @param numbers : the 81 characters of the puzzle
+ * @return true : if every character was a digit or '.'
+ * @return false : if a character was invalid, the puzzle is left empty
+ */
+bool Puzzle::load(const char *numbers)
+{
+   numberOfVariables = 0;
+   numberOfEmptyVars = 0;
+   nodeCount = 0;
+   gaveUp = false;
+   for (int number = 0; number < 81; number++)
+   {
+      char ch = numbers[number];
+      int value = (ch == '.') ? 0 : ch - '0';
+      if (value < 0 || value > 9)
+      {
+         for (int row = 0; row < 9; row++)
+         {
+            for (int col = 0; col < 9; col++)
+            {
+               puzzleGrid[row][col].setValue(-1);
+               puzzleGrid[row][col].setFixed(true);
+            }
+         }
+         numberOfVariables = 0;
+         numberOfEmptyVars = 0;
+         return false;
+      }
+      Square &square = puzzleGrid[number / 9][number % 9];
+      square.setValue(value);
+      square.setFixed(value != 0);
+      if (value == 0)
+      {
+         numberOfVariables++;
+         numberOfEmptyVars++;
+      }
+   }
+   return true;
+}
+
+/**
+ * write
+ *
+ * this function writes the current value of every square as 81
+ * characters in row-major order
+ * PRE: out must have room for at least 81 characters.
+ * @param out : buffer the characters are written to
+ */
+void Puzzle::write(char *out)
+{
+   for (int row = 0; row < 9; row++)
+   {
+      for (int col = 0; col < 9; col++)
+      {
+         int value = get(row, col);
+         out[row * 9 + col] = (value > 0) ? (char)('0' + value) : '0';
+      }
+   }
+}
+
 /**
  * Sqaure
  *
@@ -11,6 +11,7 @@
  * @copyright Copyright (c) 2021
  * 
  */
+#include <atomic>
 #include <iostream>
 #ifndef PUZZLE
 #define PUZZLE
@@ -44,7 +45,8 @@ public:
     * work.
     * PRE: the row and collumn must be between 0 and 8.
     * @return true : if the puzzle is solved
-    * @return false : false if the puzzle does not have a solution
+    * @return false : false if the puzzle does not have a solution, or if
+    * the search gave up because of setLimit (see limitReached)
     */
    bool Solve();
 
@@ -112,6 +114,72 @@ public:
     */
    friend istream &operator>>(istream &in, Puzzle &puzzle);
 
+   /**
+    * load
+    *
+    * this function resets the puzzle and initializes the squares from 81
+    * characters in row-major order. '0' or '.' marks an empty square. Unlike
+    * operator>> it does not prompt or print, so it can be used when the
+    * puzzles come from a file or a socket.
+    * PRE: numbers must point to at least 81 characters.
+    * @param numbers : the 81 characters of the puzzle
+    * @return true : if every character was a digit or '.'
+    * @return false : if a character was invalid, the puzzle is left empty
+    */
+   bool load(const char *numbers);
+
+   /**
+    * write
+    *
+    * this function writes the current value of every square as 81
+    * characters in row-major order, the same layout load reads.
+    * PRE: out must have room for at least 81 characters.
+    * @param out : buffer the characters are written to
+    */
+   void write(char *out);
+
+   /**
+    * setOrder
+    *
+    * this function sets the order Solve tries the values in and the order
+    * it fills the empty squares in. By default values are tried 1 to 9 and
+    * squares are filled row by row.
+    * PRE: values must hold 1-9 once each and squares must hold 0-80
+    * (row * 9 + col) once each.
+    * @param values : the 9 values in the order they are tried, or NULL
+    * for 1 to 9
+    * @param squares : the 81 squares in the order they are filled, or
+    * NULL for row by row
+    */
+   void setOrder(const int *values, const int *squares);
+
+   /**
+    * setLimit
+    *
+    * this function limits how much searching Solve may do before it gives
+    * up, and resets the count of nodes searched. When Solve gives up every
+    * square it filled is emptied again, so it can be called again with a
+    * larger limit or a different order.
+    * @param maxNodes : most calls to Solve before giving up, 0 for no limit
+    * @param stop : Solve gives up once *stop is true, NULL to ignore
+    */
+   void setLimit(long long maxNodes, const atomic<bool> *stop);
+
+   /**
+    * limitReached
+    *
+    * @return true : if the last Solve gave up because of setLimit, so a
+    * false from Solve does not mean the puzzle has no solution
+    */
+   bool limitReached();
+
+   /**
+    * nodes
+    *
+    * @return long long : calls to Solve since the last load or setLimit
+    */
+   long long nodes();
+
 private:
    class Square
    {
@@ -186,6 +254,24 @@ private:
    // puzzle grid that is 9 by 9 and holds squares
    Square puzzleGrid[9][9];
 
+   // order Solve tries the values 1-9 in
+   int valueOrder[9];
+
+   // order Solve fills the squares in, as row * 9 + col
+   int squareOrder[81];
+
+   // most calls to Solve before it gives up, 0 for no limit
+   long long maxNodes;
+
+   // calls to Solve since the last load or setLimit
+   long long nodeCount;
+
+   // Solve gives up once this is true, NULL if it is not used
+   const atomic<bool> *stop;
+
+   // whether the last Solve gave up because of the limits
+   bool gaveUp;
+
    /**
     * findNextEmpty
     *
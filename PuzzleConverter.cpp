@@ -0,0 +1,173 @@
+/**
+ * @file PuzzleConverter.cpp
+ * @author Katarina McGaughy
+ * @brief PuzzleConverter converts puzzle files between the text format,
+ * one 81 character puzzle per line, and the compact binary format read by
+ * PuzzleFile. The direction is picked from the input: a binary file is
+ * written out as text and a text file is written out as binary.
+ *
+ * usage: PuzzleConverter <input file> <output file> [puzzles per block]
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "PuzzleFile.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+/**
+ * validPuzzle
+ *
+ * this function checks that a puzzle line only holds digits or '.'
+ * @param line : the 81 characters of the puzzle
+ * @return true : if PuzzleFile::add accepts it
+ */
+static bool validPuzzle(const char *line)
+{
+   for (int i = 0; i < 81; i++)
+   {
+      if (line[i] != '.' && (line[i] < '0' || line[i] > '9'))
+      {
+         return false;
+      }
+   }
+   return true;
+}
+
+/**
+ * toText
+ *
+ * this function writes every puzzle of a binary file as a line of text
+ * @param contents : the binary file
+ * @param outputPath : text file to write
+ * @return int : exit status for main
+ */
+static int toText(const vector<char> &contents, const char *outputPath)
+{
+   vector<PuzzleFile::Block> blocks;
+   unsigned long long count;
+   if (!PuzzleFile::findBlocks(&contents[0], contents.size(), blocks, count))
+   {
+      cerr << "The binary puzzle file is corrupt." << endl;
+      return 1;
+   }
+   FILE *output = fopen(outputPath, "wb");
+   if (output == NULL)
+   {
+      cerr << "Could not write " << outputPath << endl;
+      return 1;
+   }
+   char line[82];
+   line[81] = '\n';
+   bool written = true;
+   for (size_t b = 0; b < blocks.size() && written; b++)
+   {
+      const unsigned char *record =
+          (const unsigned char *)&contents[blocks[b].offset];
+      for (unsigned int i = 0; i < blocks[b].puzzles && written; i++)
+      {
+         record += PuzzleFile::decode(record, line);
+         written = fwrite(line, 1, sizeof(line), output) == sizeof(line);
+      }
+   }
+   if (fclose(output) != 0 || !written)
+   {
+      cerr << "Could not write " << outputPath << endl;
+      return 1;
+   }
+   cerr << "Wrote " << count << " puzzles as text." << endl;
+   return 0;
+}
+
+/**
+ * toBinary
+ *
+ * this function writes every 81 character line of a text file to a
+ * binary puzzle file
+ * @param contents : the text file
+ * @param outputPath : binary file to write
+ * @param blockSize : puzzles per block
+ * @return int : exit status for main
+ */
+static int toBinary(const vector<char> &contents, const char *outputPath,
+                    int blockSize)
+{
+   PuzzleFile output;
+   if (!output.create(outputPath, blockSize))
+   {
+      cerr << "Could not write " << outputPath << endl;
+      return 1;
+   }
+   unsigned long long written = 0;
+   int skipped = 0;
+   size_t start = 0;
+   while (start < contents.size())
+   {
+      size_t end = start;
+      while (end < contents.size() && contents[end] != '\n')
+      {
+         end++;
+      }
+      size_t length = end - start;
+      if (length > 0 && contents[end - 1] == '\r')
+      {
+         length--;
+      }
+      if (length == 81 && validPuzzle(&contents[start]))
+      {
+         // a valid puzzle is only refused when a block could not be written
+         if (!output.add(&contents[start]))
+         {
+            output.close();
+            cerr << "Could not write " << outputPath << endl;
+            return 1;
+         }
+         written++;
+      }
+      else if (length > 0)
+      {
+         skipped++;
+      }
+      start = end + 1;
+   }
+   if (!output.close())
+   {
+      cerr << "Could not write " << outputPath << endl;
+      return 1;
+   }
+   if (skipped > 0)
+   {
+      cerr << "Skipped " << skipped << " lines that were not puzzles." << endl;
+   }
+   cerr << "Wrote " << written << " puzzles as binary." << endl;
+   return 0;
+}
+
+int main(int argc, char *argv[])
+{
+   if (argc < 3)
+   {
+      cerr << "usage: PuzzleConverter <input file> <output file> "
+              "[puzzles per block]"
+           << endl;
+      return 1;
+   }
+   int blockSize = argc > 3 ? atoi(argv[3]) : 4096;
+
+   vector<char> contents;
+   if (!PuzzleFile::readFile(argv[1], contents))
+   {
+      cerr << "Could not read " << argv[1] << endl;
+      return 1;
+   }
+   if (!contents.empty() && PuzzleFile::isBinary(&contents[0], contents.size()))
+   {
+      return toText(contents, argv[2]);
+   }
+   return toBinary(contents, argv[2], blockSize);
+}
@@ -0,0 +1,385 @@
+/**
+ * @file PuzzleFile.cpp
+ * @author Katarina McGaughy
+ * @brief The PuzzleFile class reads and writes the compact binary puzzle
+ * format: an 81 bit mask of given squares and 4 bits per given value,
+ * grouped in blocks.
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "PuzzleFile.h"
+#include <cstring>
+using namespace std;
+
+// first bytes of every binary puzzle file
+static const char MAGIC[4] = {'S', 'D', 'K', 'B'};
+
+// version written in the header
+static const unsigned char VERSION = 1;
+
+// flags written in the header; none are defined yet, the byte is kept for
+// compressed blocks, which this version cannot read
+static const unsigned char FLAGS = 0;
+
+// bytes of the mask of given squares
+static const int MASK_SIZE = 11;
+
+/**
+ * putLittleEndian
+ *
+ * this function stores an integer as little endian bytes
+ * @param out : where the bytes go
+ * @param value : the integer
+ * @param bytes : number of bytes to store
+ */
+static void putLittleEndian(unsigned char *out, unsigned long long value,
+                            int bytes)
+{
+   for (int i = 0; i < bytes; i++)
+   {
+      out[i] = (unsigned char)(value >> (8 * i));
+   }
+}
+
+/**
+ * getLittleEndian
+ *
+ * @param in : little endian bytes
+ * @param bytes : number of bytes to read
+ * @return unsigned long long : the integer
+ */
+static unsigned long long getLittleEndian(const unsigned char *in, int bytes)
+{
+   unsigned long long value = 0;
+   for (int i = 0; i < bytes; i++)
+   {
+      value |= (unsigned long long)in[i] << (8 * i);
+   }
+   return value;
+}
+
+/**
+ * recordsFit
+ *
+ * this function checks that a block's payload is exactly the records its
+ * masks call for, so decode never reads past the end of the block, and
+ * that every given square holds a value from 1 to 9
+ * @param payload : the encoded puzzles of the block
+ * @param puzzles : number of puzzles the block header claims
+ * @param bytes : bytes in the payload
+ * @return true : if every record fits and is valid, and nothing is left
+ * over
+ */
+static bool recordsFit(const unsigned char *payload, unsigned int puzzles,
+                       size_t bytes)
+{
+   size_t offset = 0;
+   for (unsigned int i = 0; i < puzzles; i++)
+   {
+      if (bytes - offset < (size_t)MASK_SIZE)
+      {
+         return false;
+      }
+      const unsigned char *mask = payload + offset;
+      // the mask holds 81 bits, the top 7 bits of its last byte are unused
+      if (mask[MASK_SIZE - 1] & 0xFE)
+      {
+         return false;
+      }
+      int givens = 0;
+      for (int b = 0; b < MASK_SIZE; b++)
+      {
+         givens += __builtin_popcount(mask[b]);
+      }
+      size_t size = MASK_SIZE + (givens + 1) / 2;
+      if (bytes - offset < size)
+      {
+         return false;
+      }
+      // decode would turn 0 into an empty square and 10-15 into ':'-'?'
+      const unsigned char *values = mask + MASK_SIZE;
+      for (int given = 0; given < givens; given++)
+      {
+         int value = (values[given / 2] >> (4 * (given % 2))) & 0xF;
+         if (value < 1 || value > 9)
+         {
+            return false;
+         }
+      }
+      offset += size;
+   }
+   return offset == bytes;
+}
+
+/**
+ * PuzzleFile
+ *
+ * constructor, nothing is opened until create is called
+ */
+PuzzleFile::PuzzleFile() : file(NULL), blockSize(0), blockPuzzles(0), count(0)
+{
+}
+
+/**
+ * ~PuzzleFile
+ *
+ * destructor, closes the file if it is still open
+ */
+PuzzleFile::~PuzzleFile()
+{
+   close();
+}
+
+/**
+ * create
+ *
+ * this function opens a new binary puzzle file for writing. The header
+ * is written now and the puzzle count is filled in by close.
+ * @param path : file to create
+ * @param blockSize : number of puzzles per block
+ * @return true : if the file was created
+ */
+bool PuzzleFile::create(const char *path, int blockSize)
+{
+   close();
+   file = fopen(path, "wb");
+   if (file == NULL)
+   {
+      return false;
+   }
+   this->blockSize = blockSize < 1 ? 1 : blockSize;
+   block.clear();
+   block.reserve((size_t)this->blockSize * MAX_RECORD);
+   blockPuzzles = 0;
+   count = 0;
+
+   unsigned char header[HEADER_SIZE];
+   memset(header, 0, sizeof(header));
+   memcpy(header, MAGIC, sizeof(MAGIC));
+   header[4] = VERSION;
+   header[5] = FLAGS;
+   putLittleEndian(header + 8, this->blockSize, 4);
+   return fwrite(header, 1, sizeof(header), file) == sizeof(header);
+}
+
+/**
+ * add
+ *
+ * this function appends one puzzle to the file
+ * @param numbers : 81 characters, '0' or '.' for empty squares
+ * @return true : if the puzzle was valid and written
+ */
+bool PuzzleFile::add(const char *numbers)
+{
+   unsigned char record[MAX_RECORD];
+   int size = encode(numbers, record);
+   if (file == NULL || size < 0)
+   {
+      return false;
+   }
+   block.insert(block.end(), record, record + size);
+   blockPuzzles++;
+   count++;
+   if ((int)blockPuzzles == blockSize)
+   {
+      return flushBlock();
+   }
+   return true;
+}
+
+/**
+ * close
+ *
+ * this function writes the last block and the final puzzle count
+ * @return true : if everything was written
+ */
+bool PuzzleFile::close()
+{
+   if (file == NULL)
+   {
+      return true;
+   }
+   bool ok = flushBlock();
+   unsigned char total[8];
+   putLittleEndian(total, count, 8);
+   ok = ok && fseek(file, 12, SEEK_SET) == 0 &&
+        fwrite(total, 1, sizeof(total), file) == sizeof(total);
+   ok = (fclose(file) == 0) && ok;
+   file = NULL;
+   return ok;
+}
+
+/**
+ * flushBlock
+ *
+ * this function writes the block being filled to the file
+ * @return true : if it was written
+ */
+bool PuzzleFile::flushBlock()
+{
+   if (blockPuzzles == 0)
+   {
+      return true;
+   }
+   unsigned char header[BLOCK_HEADER_SIZE];
+   putLittleEndian(header, blockPuzzles, 4);
+   putLittleEndian(header + 4, block.size(), 4);
+   bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+             fwrite(&block[0], 1, block.size(), file) == block.size();
+   block.clear();
+   blockPuzzles = 0;
+   return ok;
+}
+
+/**
+ * isBinary
+ *
+ * this function checks for the header of the binary format
+ * @param data : start of the file
+ * @param length : bytes in the file
+ * @return true : if the file is in the binary format
+ */
+bool PuzzleFile::isBinary(const char *data, size_t length)
+{
+   return length >= (size_t)HEADER_SIZE &&
+          memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+/**
+ * findBlocks
+ *
+ * this function lists the blocks of a binary file held in memory. Files
+ * with flags this version does not know are rejected. The masks of every
+ * record are checked against the size of its block and every given value
+ * is checked, but the puzzles are not decoded.
+ * @param data : the whole file
+ * @param length : bytes in the file
+ * @param blocks : filled with one entry per block
+ * @param count : set to the number of puzzles in the file
+ * @return true : if the file is complete and not corrupt
+ */
+bool PuzzleFile::findBlocks(const char *data, size_t length,
+                            vector<Block> &blocks, unsigned long long &count)
+{
+   const unsigned char *bytes = (const unsigned char *)data;
+   blocks.clear();
+   count = 0;
+   if (!isBinary(data, length) || bytes[4] != VERSION || bytes[5] != FLAGS)
+   {
+      return false;
+   }
+   unsigned long long expected = getLittleEndian(bytes + 12, 8);
+   size_t offset = HEADER_SIZE;
+   while (offset + BLOCK_HEADER_SIZE <= length)
+   {
+      Block next;
+      next.puzzles = (unsigned int)getLittleEndian(bytes + offset, 4);
+      size_t payload = (size_t)getLittleEndian(bytes + offset + 4, 4);
+      next.offset = offset + BLOCK_HEADER_SIZE;
+      next.first = count;
+      if (payload > length - next.offset ||
+          !recordsFit(bytes + next.offset, next.puzzles, payload))
+      {
+         break;
+      }
+      blocks.push_back(next);
+      count += next.puzzles;
+      offset = next.offset + payload;
+   }
+   if (offset != length || count != expected)
+   {
+      blocks.clear();
+      count = 0;
+      return false;
+   }
+   return true;
+}
+
+/**
+ * readFile
+ *
+ * this function reads a whole puzzle file, text or binary, into memory
+ * @param path : file to read
+ * @param contents : filled with the bytes of the file
+ * @return true : if the file could be read
+ */
+bool PuzzleFile::readFile(const char *path, vector<char> &contents)
+{
+   FILE *file = fopen(path, "rb");
+   if (file == NULL)
+   {
+      return false;
+   }
+   fseek(file, 0, SEEK_END);
+   long length = ftell(file);
+   fseek(file, 0, SEEK_SET);
+   contents.resize(length > 0 ? length : 0);
+   size_t read = contents.empty() ? 0 : fread(&contents[0], 1, length, file);
+   fclose(file);
+   return read == contents.size();
+}
+
+/**
+ * encode
+ *
+ * this function packs one puzzle into the binary record format: bit i of
+ * the mask is set if square i is given, then the given values follow two
+ * to a byte, low nibble first
+ * @param numbers : 81 characters, '0' or '.' for empty squares
+ * @param record : room for at least MAX_RECORD bytes
+ * @return int : bytes written, or -1 if a character was invalid
+ */
+int PuzzleFile::encode(const char *numbers, unsigned char *record)
+{
+   memset(record, 0, MAX_RECORD);
+   int givens = 0;
+   for (int square = 0; square < 81; square++)
+   {
+      char ch = numbers[square];
+      int value = (ch == '.') ? 0 : ch - '0';
+      if (value < 0 || value > 9)
+      {
+         return -1;
+      }
+      if (value != 0)
+      {
+         record[square / 8] |= (unsigned char)(1 << (square % 8));
+         int shift = 4 * (givens % 2);
+         record[MASK_SIZE + givens / 2] |= (unsigned char)(value << shift);
+         givens++;
+      }
+   }
+   return MASK_SIZE + (givens + 1) / 2;
+}
+
+/**
+ * decode
+ *
+ * this function unpacks one record into 81 characters that
+ * Puzzle::load accepts
+ * @param record : the encoded puzzle
+ * @param numbers : room for 81 characters
+ * @return int : bytes of record that were read
+ */
+int PuzzleFile::decode(const unsigned char *record, char *numbers)
+{
+   const unsigned char *values = record + MASK_SIZE;
+   int givens = 0;
+   for (int square = 0; square < 81; square++)
+   {
+      if (record[square / 8] & (1 << (square % 8)))
+      {
+         int shift = 4 * (givens % 2);
+         numbers[square] = (char)('0' + ((values[givens / 2] >> shift) & 0xF));
+         givens++;
+      }
+      else
+      {
+         numbers[square] = '0';
+      }
+   }
+   return MASK_SIZE + (givens + 1) / 2;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file PuzzleFile.h
+ * @author Katarina McGaughy
+ * @brief The PuzzleFile class reads and writes the compact binary puzzle
+ * format. A puzzle is stored as an 81 bit mask of which squares are given
+ * (11 bytes) followed by the value of every given square packed 4 bits
+ * each, so a puzzle with 25 givens takes 24 bytes instead of the 82 of a
+ * text line. Puzzles are grouped in blocks so a file can be split between
+ * threads without decoding it first.
+ *
+ * Layout, all integers little endian:
+ *    header : "SDKB", version (1 byte), flags (1 byte), 2 reserved bytes,
+ *             puzzles per block (4 bytes), number of puzzles (8 bytes)
+ * The flags are 0; the byte is kept for compressed blocks.
+ *    block  : number of puzzles (4 bytes), payload bytes (4 bytes), payload
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+#ifndef PUZZLEFILE
+#define PUZZLEFILE
+using namespace std;
+
+class PuzzleFile
+{
+
+public:
+   // bytes in the file header
+   static const int HEADER_SIZE = 20;
+
+   // bytes in the header of every block
+   static const int BLOCK_HEADER_SIZE = 8;
+
+   // largest encoded puzzle: the mask and 81 values
+   static const int MAX_RECORD = 11 + 41;
+
+   // where one block of puzzles is in a file
+   struct Block
+   {
+      // offset of the first encoded puzzle
+      size_t offset;
+      // number of puzzles in the block
+      unsigned int puzzles;
+      // index of the first puzzle of the block in the whole file
+      unsigned long long first;
+   };
+
+   /**
+    * PuzzleFile
+    *
+    * constructor, nothing is opened until create is called
+    */
+   PuzzleFile();
+
+   /**
+    * ~PuzzleFile
+    *
+    * destructor, closes the file if it is still open
+    */
+   ~PuzzleFile();
+
+   /**
+    * create
+    *
+    * this function opens a new binary puzzle file for writing
+    * @param path : file to create
+    * @param blockSize : number of puzzles per block
+    * @return true : if the file was created
+    */
+   bool create(const char *path, int blockSize);
+
+   /**
+    * add
+    *
+    * this function appends one puzzle to the file
+    * @param numbers : 81 characters, '0' or '.' for empty squares
+    * @return true : if the puzzle was valid and written
+    */
+   bool add(const char *numbers);
+
+   /**
+    * close
+    *
+    * this function writes the last block and the final puzzle count
+    * @return true : if everything was written
+    */
+   bool close();
+
+   /**
+    * isBinary
+    *
+    * this function checks for the header of the binary format
+    * @param data : start of the file
+    * @param length : bytes in the file
+    * @return true : if the file is in the binary format
+    */
+   static bool isBinary(const char *data, size_t length);
+
+   /**
+    * findBlocks
+    *
+    * this function lists the blocks of a binary file held in memory
+    * @param data : the whole file
+    * @param length : bytes in the file
+    * @param blocks : filled with one entry per block
+    * @param count : set to the number of puzzles in the file
+    * @return true : if the file is complete and not corrupt
+    */
+   static bool findBlocks(const char *data, size_t length,
+                          vector<Block> &blocks, unsigned long long &count);
+
+   /**
+    * readFile
+    *
+    * this function reads a whole puzzle file, text or binary, into memory
+    * @param path : file to read
+    * @param contents : filled with the bytes of the file
+    * @return true : if the file could be read
+    */
+   static bool readFile(const char *path, vector<char> &contents);
+
+   /**
+    * encode
+    *
+    * this function packs one puzzle into the binary record format
+    * @param numbers : 81 characters, '0' or '.' for empty squares
+    * @param record : room for at least MAX_RECORD bytes
+    * @return int : bytes written, or -1 if a character was invalid
+    */
+   static int encode(const char *numbers, unsigned char *record);
+
+   /**
+    * decode
+    *
+    * this function unpacks one record into 81 characters that
+    * Puzzle::load accepts
+    * @param record : the encoded puzzle
+    * @param numbers : room for 81 characters
+    * @return int : bytes of record that were read
+    */
+   static int decode(const unsigned char *record, char *numbers);
+
+private:
+   // file being written, NULL when closed
+   FILE *file;
+
+   // number of puzzles per block
+   int blockSize;
+
+   // encoded puzzles of the block being filled
+   vector<unsigned char> block;
+
+   // puzzles in the block being filled
+   unsigned int blockPuzzles;
+
+   // puzzles written so far
+   unsigned long long count;
+
+   /**
+    * flushBlock
+    *
+    * this function writes the block being filled to the file
+    * @return true : if it was written
+    */
+   bool flushBlock();
+};
+#endif
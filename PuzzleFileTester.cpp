@@ -0,0 +1,209 @@
+/**
+ * @file PuzzleFileTester.cpp
+ * @author Katarina McGaughy
+ * @brief PuzzleFileTester performs tests on the PuzzleFile class by
+ * writing puzzles to a binary file and reading them back as text, and by
+ * checking that binary files with unknown flags or corrupt blocks are
+ * rejected
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "PuzzleFile.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+/**
+ * putLittleEndian
+ *
+ * this function appends an integer as little endian bytes
+ * @param out : where the bytes go
+ * @param value : the integer
+ * @param bytes : number of bytes to store
+ */
+static void putLittleEndian(vector<char> &out, unsigned long long value,
+                            int bytes)
+{
+   for (int i = 0; i < bytes; i++)
+   {
+      out.push_back((char)(value >> (8 * i)));
+   }
+}
+
+/**
+ * oneBlockFile
+ *
+ * this function builds a binary puzzle file holding one block
+ * @param puzzles : puzzles the headers claim
+ * @param payload : the encoded puzzles of the block
+ * @return vector<char> : the bytes of the file
+ */
+static vector<char> oneBlockFile(unsigned int puzzles,
+                                 const vector<char> &payload)
+{
+   vector<char> file;
+   file.push_back('S');
+   file.push_back('D');
+   file.push_back('K');
+   file.push_back('B');
+   file.push_back(1); // version
+   file.push_back(0); // flags
+   putLittleEndian(file, 0, 2);
+   putLittleEndian(file, 4096, 4);
+   putLittleEndian(file, puzzles, 8);
+   putLittleEndian(file, puzzles, 4);
+   putLittleEndian(file, payload.size(), 4);
+   file.insert(file.end(), payload.begin(), payload.end());
+   return file;
+}
+
+/**
+ * accepted
+ *
+ * @param file : bytes of a binary puzzle file
+ * @return true : if findBlocks accepts the file
+ */
+static bool accepted(const vector<char> &file)
+{
+   vector<PuzzleFile::Block> blocks;
+   unsigned long long count;
+   return PuzzleFile::findBlocks(&file[0], file.size(), blocks, count);
+}
+
+int main()
+{
+   const char *path = "PuzzleFileTester.bin";
+   string puzzles[4] = {
+       "530070000600195000098000060800060003400803001700020006060000280000419005000080079",
+       "..9748...7.........2.1.9.....7...24..64.1.59..98...3.....8.3.2.........6...2759..",
+       "000000000000000000000000000000000000000000000000000000000000000000000000000000000",
+       "534678912672195348198342567859761423426853791713924856961537284287419635345286179"};
+   int failures = 0;
+
+   // text -> binary -> text, with a block size that leaves a partial block
+   PuzzleFile output;
+   output.create(path, 3);
+   for (int i = 0; i < 4; i++)
+   {
+      output.add(puzzles[i].c_str());
+   }
+   if (!output.close())
+   {
+      cout << "Could not write " << path << endl;
+      return 1;
+   }
+
+   vector<char> contents;
+   vector<PuzzleFile::Block> blocks;
+   unsigned long long count = 0;
+   PuzzleFile::readFile(path, contents);
+   remove(path);
+   if (!PuzzleFile::findBlocks(&contents[0], contents.size(), blocks, count) ||
+       count != 4 || blocks.size() != 2)
+   {
+      cout << "Round trip file was not read back." << endl;
+      failures++;
+   }
+   for (size_t b = 0; b < blocks.size(); b++)
+   {
+      const unsigned char *record =
+          (const unsigned char *)&contents[blocks[b].offset];
+      for (unsigned int i = 0; i < blocks[b].puzzles; i++)
+      {
+         char numbers[81];
+         record += PuzzleFile::decode(record, numbers);
+         string expected = puzzles[blocks[b].first + i];
+         for (size_t c = 0; c < expected.length(); c++)
+         {
+            expected[c] = expected[c] == '.' ? '0' : expected[c];
+         }
+         if (string(numbers, 81) != expected)
+         {
+            cout << "Puzzle " << blocks[b].first + i << " changed." << endl;
+            failures++;
+         }
+      }
+   }
+   cout << "Round trip of " << count << " puzzles in " << contents.size()
+        << " bytes." << endl;
+
+   // a record of every given square needs 11 + 41 bytes
+   vector<char> payload(11, (char)0xFF);
+   payload[10] = 0x01;
+   payload.resize(52, 0x11);
+   if (!accepted(oneBlockFile(1, payload)))
+   {
+      cout << "A valid full record was rejected." << endl;
+      failures++;
+   }
+
+   // the masks call for 41 value bytes that the block does not have
+   payload.resize(11);
+   if (accepted(oneBlockFile(1, payload)))
+   {
+      cout << "A block too short for its masks was accepted." << endl;
+      failures++;
+   }
+
+   // bits past square 80 are set
+   payload.assign(12, 0);
+   payload[10] = (char)0x80;
+   if (accepted(oneBlockFile(1, payload)))
+   {
+      cout << "A mask with bits past square 80 was accepted." << endl;
+      failures++;
+   }
+
+   // bytes left over after the last record
+   payload.assign(12, 0);
+   if (accepted(oneBlockFile(1, payload)))
+   {
+      cout << "A block with bytes left over was accepted." << endl;
+      failures++;
+   }
+
+   // one given square, in the low half of the value byte
+   payload.assign(12, 0);
+   payload[0] = 0x01;
+   payload[11] = 0x05;
+   vector<char> file = oneBlockFile(1, payload);
+   if (!accepted(file))
+   {
+      cout << "A valid one given record was rejected." << endl;
+      failures++;
+   }
+
+   // a flag this version does not know, such as compressed blocks
+   file[5] = 0x01;
+   if (accepted(file))
+   {
+      cout << "A file with unknown flags was accepted." << endl;
+      failures++;
+   }
+
+   // given squares must hold 1-9
+   payload[11] = 0x00;
+   if (accepted(oneBlockFile(1, payload)))
+   {
+      cout << "A given value of 0 was accepted." << endl;
+      failures++;
+   }
+   payload[11] = 0x0A;
+   if (accepted(oneBlockFile(1, payload)))
+   {
+      cout << "A given value of 10 was accepted." << endl;
+      failures++;
+   }
+
+   if (failures == 0)
+   {
+      cout << "All PuzzleFile tests passed." << endl;
+   }
+   return failures == 0 ? 0 : 1;
+}
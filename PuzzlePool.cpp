@@ -0,0 +1,85 @@
+/**
+ * @file PuzzlePool.cpp
+ * @author Katarina McGaughy
+ * @brief The PuzzlePool class allocates a fixed number of Puzzle objects
+ * once and hands them out for reuse through an O(1) free list.
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "PuzzlePool.h"
+using namespace std;
+
+/**
+ * PuzzlePool
+ *
+ * constructor, allocates every puzzle the pool will ever hand out
+ * PRE: capacity must be at least 1.
+ * @param capacity : number of puzzles in the pool
+ */
+PuzzlePool::PuzzlePool(int capacity)
+    : puzzles(new Puzzle[capacity]), freeList(new int[capacity]),
+      freeCount(capacity), capacity(capacity)
+{
+   // hand out the lowest index first
+   for (int i = 0; i < capacity; i++)
+   {
+      freeList[i] = capacity - 1 - i;
+   }
+}
+
+/**
+ * ~PuzzlePool
+ *
+ * destructor, frees the puzzles
+ */
+PuzzlePool::~PuzzlePool()
+{
+   delete[] puzzles;
+   delete[] freeList;
+}
+
+/**
+ * acquire
+ *
+ * this function takes a puzzle off the free list
+ * @return Puzzle* : a puzzle to load and solve, or NULL if all
+ * puzzles are in use
+ */
+Puzzle *PuzzlePool::acquire()
+{
+   lock_guard<mutex> guard(lock);
+   if (freeCount == 0)
+   {
+      return NULL;
+   }
+   freeCount--;
+   return &puzzles[freeList[freeCount]];
+}
+
+/**
+ * release
+ *
+ * this function puts a puzzle back on the free list
+ * PRE: puzzle must have come from acquire on this pool.
+ * @param puzzle : the puzzle that is no longer used
+ */
+void PuzzlePool::release(Puzzle *puzzle)
+{
+   lock_guard<mutex> guard(lock);
+   freeList[freeCount] = (int)(puzzle - puzzles);
+   freeCount++;
+}
+
+/**
+ * available
+ *
+ * @return int : number of puzzles that can still be acquired
+ */
+int PuzzlePool::available()
+{
+   lock_guard<mutex> guard(lock);
+   return freeCount;
+}
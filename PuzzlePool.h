@@ -0,0 +1,87 @@
+/**
+ * @file PuzzlePool.h
+ * @author Katarina McGaughy
+ * @brief The PuzzlePool class allocates a fixed number of Puzzle objects
+ * once and hands them out for reuse, so solving millions of puzzles does
+ * not construct and destroy 81 squares per puzzle. Puzzles are handed out
+ * from a free list; acquire and release are O(1) and never touch the heap.
+ * A released puzzle is not cleared, because Puzzle::load overwrites every
+ * square of the next puzzle anyway.
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "Puzzle.h"
+#include <mutex>
+#ifndef PUZZLEPOOL
+#define PUZZLEPOOL
+using namespace std;
+
+class PuzzlePool
+{
+
+public:
+   /**
+    * PuzzlePool
+    *
+    * constructor, allocates every puzzle the pool will ever hand out
+    * PRE: capacity must be at least 1.
+    * @param capacity : number of puzzles in the pool
+    */
+   PuzzlePool(int capacity);
+
+   /**
+    * ~PuzzlePool
+    *
+    * destructor, frees the puzzles. Every puzzle must have been released.
+    */
+   ~PuzzlePool();
+
+   /**
+    * acquire
+    *
+    * this function takes a puzzle off the free list
+    * @return Puzzle* : a puzzle to load and solve, or NULL if all
+    * puzzles are in use
+    */
+   Puzzle *acquire();
+
+   /**
+    * release
+    *
+    * this function puts a puzzle back on the free list
+    * PRE: puzzle must have come from acquire on this pool.
+    * @param puzzle : the puzzle that is no longer used
+    */
+   void release(Puzzle *puzzle);
+
+   /**
+    * available
+    *
+    * @return int : number of puzzles that can still be acquired
+    */
+   int available();
+
+private:
+   // puzzles owned by the pool
+   Puzzle *puzzles;
+
+   // indexes of the puzzles that are free, used as a stack
+   int *freeList;
+
+   // number of entries in freeList
+   int freeCount;
+
+   // number of puzzles in the pool
+   int capacity;
+
+   // guards freeList and freeCount
+   mutex lock;
+
+   // a pool owns its puzzles so it is not copied
+   PuzzlePool(const PuzzlePool &);
+   PuzzlePool &operator=(const PuzzlePool &);
+};
+#endif
@@ -0,0 +1,123 @@
+/**
+ * @file PuzzlePoolTester.cpp
+ * @author Katarina McGaughy
+ * @brief PuzzlePoolTester performs tests on the PuzzlePool class by
+ * taking every puzzle out of a small pool, putting them back and taking
+ * them again, and by solving puzzles with a pooled Puzzle. When built
+ * with -DCOUNT_ALLOCATIONS it also checks that acquiring, loading and
+ * solving never allocate.
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "AllocationCounter.h"
+#include "Puzzle.h"
+#include "PuzzlePool.h"
+#include <iostream>
+#include <set>
+using namespace std;
+
+int main()
+{
+   const int capacity = 3;
+   const char *puzzles[3] = {
+       "530070000600195000098000060800060003400803001700020006060000280000419005000080079",
+       "..9748...7.........2.1.9.....7...24..64.1.59..98...3.....8.3.2.........6...2759..",
+       "000000000000000000000000000859761423426853791713924856961537284287419635345286179"};
+   int failures = 0;
+   long long start = AllocationCounter::threadAllocations();
+   PuzzlePool pool(capacity);
+   if (AllocationCounter::enabled() &&
+       AllocationCounter::threadAllocations() == start)
+   {
+      cout << "Creating the pool was not counted, so the allocation counter "
+              "does not work."
+           << endl;
+      failures++;
+   }
+
+   // every puzzle can be taken once, then the pool is empty
+   Puzzle *taken[capacity];
+   set<Puzzle *> distinct;
+   for (int i = 0; i < capacity; i++)
+   {
+      taken[i] = pool.acquire();
+      distinct.insert(taken[i]);
+   }
+   if (distinct.count(NULL) != 0 || (int)distinct.size() != capacity)
+   {
+      cout << "The pool did not hand out " << capacity << " different puzzles."
+           << endl;
+      failures++;
+   }
+   if (pool.acquire() != NULL || pool.available() != 0)
+   {
+      cout << "An exhausted pool handed out another puzzle." << endl;
+      failures++;
+   }
+
+   // a released puzzle is the next one handed out
+   pool.release(taken[1]);
+   if (pool.available() != 1 || pool.acquire() != taken[1])
+   {
+      cout << "A released puzzle was not reused." << endl;
+      failures++;
+   }
+
+   // after releasing all of them the same puzzles come back
+   for (int i = 0; i < capacity; i++)
+   {
+      pool.release(taken[i]);
+   }
+   for (int i = 0; i < capacity; i++)
+   {
+      if (distinct.count(pool.acquire()) != 1)
+      {
+         cout << "A puzzle from outside the pool was handed out." << endl;
+         failures++;
+      }
+   }
+   for (int i = 0; i < capacity; i++)
+   {
+      pool.release(taken[i]);
+   }
+
+   // solve with pooled puzzles the way BatchSolver does
+   long long before = AllocationCounter::threadAllocations();
+   int solved = 0;
+   for (int round = 0; round < 10; round++)
+   {
+      Puzzle *puzzle = pool.acquire();
+      solved += puzzle->load(puzzles[round % 3]) && puzzle->Solve();
+      pool.release(puzzle);
+   }
+   long long allocations = AllocationCounter::threadAllocations() - before;
+   if (solved != 10)
+   {
+      cout << "Only " << solved << " of 10 pooled puzzles were solved." << endl;
+      failures++;
+   }
+   if (AllocationCounter::enabled())
+   {
+      if (allocations != 0)
+      {
+         cout << "Solving with a pooled puzzle made " << allocations
+              << " heap allocations." << endl;
+         failures++;
+      }
+   }
+   else
+   {
+      cout << "Allocation counting is off; build with -DCOUNT_ALLOCATIONS to "
+              "check the solving loop."
+           << endl;
+   }
+
+   if (failures == 0)
+   {
+      cout << "All PuzzlePool tests passed." << endl;
+   }
+   return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,398 @@
+/**
+ * @file SolutionEnumerator.cpp
+ * @author Katarina McGaughy
+ * @brief The SolutionEnumerator class finds every solution of a puzzle on
+ * several threads and passes them to a sink in chunks.
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "SolutionEnumerator.h"
+#include <chrono>
+#include <thread>
+using namespace std;
+
+// solutions a thread buffers before passing them to the sink
+static const size_t CHUNK = 4096;
+
+// bit mask of the values 1-9
+static const unsigned short ALL_VALUES = 0x3FE;
+
+// the search is split into about this many smaller puzzles per thread
+static const size_t PROBLEMS_PER_THREAD = 64;
+
+/**
+ * boxOf
+ *
+ * @param square : row * 9 + col
+ * @return int : the box the square is in, 0-8 row by row
+ */
+static inline int boxOf(int square)
+{
+   return (square / 27) * 3 + (square % 9) / 3;
+}
+
+/**
+ * SolutionEnumerator
+ *
+ * constructor
+ * @param numThreads : number of threads searching
+ * @param limit : stop after this many solutions, 0 for all of them
+ */
+SolutionEnumerator::SolutionEnumerator(int numThreads, unsigned long long limit)
+    : numThreads(numThreads < 1 ? 1 : numThreads), limit(limit),
+      nextProblem(0), total(0), stopping(false), sink(NULL), context(NULL),
+      elapsed(0)
+{
+}
+
+/**
+ * enumerate
+ *
+ * this function finds the solutions of the puzzle and passes them to
+ * the sink
+ * @param puzzle : the loaded puzzle, it is not changed
+ * @param sink : where solutions go, or NULL to only count them
+ * @param context : passed to every call of sink
+ * @return unsigned long long : number of solutions found
+ */
+unsigned long long SolutionEnumerator::enumerate(Puzzle &puzzle, Sink sink,
+                                                 void *context)
+{
+   chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+   this->sink = sink;
+   this->context = context;
+   frontier.clear();
+   nextProblem = 0;
+   total = 0;
+   stopping = false;
+
+   State start;
+   for (int i = 0; i < 9; i++)
+   {
+      start.rows[i] = 0;
+      start.cols[i] = 0;
+      start.boxes[i] = 0;
+   }
+   start.empty = 81; // place counts the givens off
+   bool valid = true;
+   for (int square = 0; square < 81; square++)
+   {
+      int value = puzzle.get(square / 9, square % 9);
+      start.grid[square] = 0;
+      if (value < 1 || value > 9)
+      {
+         continue;
+      }
+      if ((start.rows[square / 9] | start.cols[square % 9] |
+           start.boxes[boxOf(square)]) & (1 << value))
+      {
+         valid = false; // two givens clash, so there are no solutions
+      }
+      else
+      {
+         place(start, square, value);
+      }
+   }
+
+   unsigned long long found = 0;
+   if (valid)
+   {
+      split(start);
+      vector<Worker> workers(numThreads);
+      for (int t = 0; t < numThreads; t++)
+      {
+         workers[t].grids.resize(sink != NULL ? CHUNK * 81 : 0);
+         workers[t].buffered = 0;
+         workers[t].found = 0;
+      }
+      vector<thread> helpers;
+      for (int t = 1; t < numThreads; t++)
+      {
+         helpers.push_back(thread(&SolutionEnumerator::run, this, &workers[t]));
+      }
+      run(&workers[0]);
+      for (size_t i = 0; i < helpers.size(); i++)
+      {
+         helpers[i].join();
+      }
+      for (int t = 0; t < numThreads; t++)
+      {
+         found += workers[t].found;
+      }
+   }
+
+   elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin)
+                 .count();
+   return found;
+}
+
+/**
+ * seconds
+ *
+ * @return double : how long the last enumerate took
+ */
+double SolutionEnumerator::seconds()
+{
+   return elapsed;
+}
+
+/**
+ * subproblems
+ *
+ * @return size_t : number of smaller puzzles the last search was
+ * split into
+ */
+size_t SolutionEnumerator::subproblems()
+{
+   return frontier.size();
+}
+
+/**
+ * limitReached
+ *
+ * @return true : if the last enumerate stopped because the puzzle has
+ * more solutions than the limit
+ */
+bool SolutionEnumerator::limitReached()
+{
+   return stopping;
+}
+
+/**
+ * place
+ *
+ * this function puts a value in an empty square of a state
+ * @param state : the state to change
+ * @param square : row * 9 + col of the square
+ * @param value : value 1-9
+ */
+void SolutionEnumerator::place(State &state, int square, int value)
+{
+   unsigned short bit = (unsigned short)(1 << value);
+   state.grid[square] = (unsigned char)value;
+   state.rows[square / 9] |= bit;
+   state.cols[square % 9] |= bit;
+   state.boxes[boxOf(square)] |= bit;
+   state.empty--;
+}
+
+/**
+ * unplace
+ *
+ * this function empties a square that place filled
+ * @param state : the state to change
+ * @param square : row * 9 + col of the square
+ * @param value : value the square holds
+ */
+void SolutionEnumerator::unplace(State &state, int square, int value)
+{
+   unsigned short bit = (unsigned short)~(1 << value);
+   state.grid[square] = 0;
+   state.rows[square / 9] &= bit;
+   state.cols[square % 9] &= bit;
+   state.boxes[boxOf(square)] &= bit;
+   state.empty++;
+}
+
+/**
+ * bestSquare
+ *
+ * this function finds the empty square with the fewest values left. It
+ * stops early at a square with no values left, since the state then has
+ * no solutions, or with one, since nothing can beat that.
+ * @param state : the state to look at
+ * @param candidates : set to the bit mask of values left for it
+ * @return int : the square, or -1 if there are no empty squares
+ */
+int SolutionEnumerator::bestSquare(const State &state,
+                                   unsigned short &candidates)
+{
+   int best = -1;
+   int bestCount = 10;
+   for (int square = 0; square < 81; square++)
+   {
+      if (state.grid[square] != 0)
+      {
+         continue;
+      }
+      unsigned short left = ALL_VALUES & ~(state.rows[square / 9] |
+                                           state.cols[square % 9] |
+                                           state.boxes[boxOf(square)]);
+      int count = __builtin_popcount(left);
+      if (count < bestCount)
+      {
+         best = square;
+         bestCount = count;
+         candidates = left;
+         if (count <= 1)
+         {
+            break;
+         }
+      }
+   }
+   return best;
+}
+
+/**
+ * split
+ *
+ * this function fills frontier with smaller puzzles that together have
+ * the same solutions as start. One square of every state is filled in
+ * every possible way at a time until there are enough states for the
+ * threads to share.
+ * @param start : the puzzle as loaded
+ */
+void SolutionEnumerator::split(const State &start)
+{
+   size_t wanted = numThreads == 1 ? 1 : numThreads * PROBLEMS_PER_THREAD;
+   vector<State> next;
+   frontier.push_back(start);
+   while (frontier.size() < wanted)
+   {
+      bool expanded = false;
+      next.clear();
+      for (size_t i = 0; i < frontier.size(); i++)
+      {
+         unsigned short candidates = 0;
+         int square = bestSquare(frontier[i], candidates);
+         if (square < 0)
+         {
+            next.push_back(frontier[i]); // already a solution
+            continue;
+         }
+         while (candidates != 0)
+         {
+            int value = __builtin_ctz(candidates);
+            candidates &= candidates - 1;
+            next.push_back(frontier[i]);
+            place(next.back(), square, value);
+         }
+         expanded = true;
+      }
+      frontier.swap(next);
+      if (!expanded)
+      {
+         break;
+      }
+   }
+}
+
+/**
+ * run
+ *
+ * this function is run by every thread. It searches frontier entries
+ * until there are none left or the limit is passed.
+ * @param worker : the calling thread's buffers and counters
+ */
+void SolutionEnumerator::run(Worker *worker)
+{
+   while (!stopping)
+   {
+      size_t problem = nextProblem++;
+      if (problem >= frontier.size())
+      {
+         break;
+      }
+      State state = frontier[problem];
+      if (!search(state, *worker))
+      {
+         break;
+      }
+   }
+   flush(*worker);
+}
+
+/**
+ * search
+ *
+ * this function finds every solution of a state, depth first, always
+ * filling the square with the fewest values left
+ * @param state : the state to search, it is restored afterwards
+ * @param worker : the calling thread's buffers and counters
+ * @return true : to keep searching, false once the limit was passed
+ */
+bool SolutionEnumerator::search(State &state, Worker &worker)
+{
+   if (state.empty == 0)
+   {
+      return report(state, worker);
+   }
+   if (stopping.load(memory_order_relaxed))
+   {
+      return false;
+   }
+   unsigned short candidates = 0;
+   int square = bestSquare(state, candidates);
+   while (candidates != 0)
+   {
+      int value = __builtin_ctz(candidates);
+      candidates &= candidates - 1;
+      place(state, square, value);
+      bool keepGoing = search(state, worker);
+      unplace(state, square, value);
+      if (!keepGoing)
+      {
+         return false;
+      }
+   }
+   return true;
+}
+
+/**
+ * report
+ *
+ * this function records one solution, and buffers it for the sink if
+ * there is one. A solution past the limit is not recorded.
+ * @param state : a full grid
+ * @param worker : the calling thread's buffers and counters
+ * @return true : to keep searching, false once the limit was passed
+ */
+bool SolutionEnumerator::report(const State &state, Worker &worker)
+{
+   if (limit != 0)
+   {
+      unsigned long long before = total.fetch_add(1);
+      // the search goes on after the limit-th solution until one more
+      // turns up, so reaching the limit means there are more solutions
+      if (before >= limit)
+      {
+         stopping = true;
+         return false;
+      }
+   }
+   worker.found++;
+   if (sink != NULL)
+   {
+      char *grid = &worker.grids[worker.buffered * 81];
+      for (int square = 0; square < 81; square++)
+      {
+         grid[square] = (char)('0' + state.grid[square]);
+      }
+      worker.buffered++;
+      if (worker.buffered == CHUNK)
+      {
+         flush(worker);
+      }
+   }
+   return !stopping.load(memory_order_relaxed);
+}
+
+/**
+ * flush
+ *
+ * this function passes the solutions a thread has buffered to the sink
+ * @param worker : the calling thread's buffers
+ */
+void SolutionEnumerator::flush(Worker &worker)
+{
+   if (sink == NULL || worker.buffered == 0)
+   {
+      return;
+   }
+   lock_guard<mutex> lock(sinkLock);
+   sink(&worker.grids[0], worker.buffered, context);
+   worker.buffered = 0;
+}
@@ -0,0 +1,217 @@
+/**
+ * @file SolutionEnumerator.h
+ * @author Katarina McGaughy
+ * @brief The SolutionEnumerator class finds every solution of a puzzle
+ * instead of stopping at the first one, for puzzles with few givens that
+ * have many solutions. The search is split into many smaller puzzles by
+ * filling in the first few squares every possible way, and threads take
+ * those smaller puzzles one at a time. Solutions are passed to a sink in
+ * chunks, so the sink can write or count them without slowing the
+ * search down.
+ *
+ * The search keeps the values used in each row, column and box as bit
+ * masks and always fills the empty square with the fewest possible values
+ * next, which is much faster per node than Puzzle::Solve.
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "Puzzle.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#ifndef SOLUTIONENUMERATOR
+#define SOLUTIONENUMERATOR
+using namespace std;
+
+class SolutionEnumerator
+{
+
+public:
+   /**
+    * Sink
+    *
+    * receives solutions, 81 characters each, back to back. Calls are
+    * never made at the same time, so a sink does not need a lock.
+    * @param grids : count solutions of 81 characters '1'-'9'
+    * @param count : number of solutions in grids
+    * @param context : the pointer given to enumerate
+    */
+   typedef void (*Sink)(const char *grids, size_t count, void *context);
+
+   /**
+    * SolutionEnumerator
+    *
+    * constructor
+    * @param numThreads : number of threads searching
+    * @param limit : stop after this many solutions, 0 for all of them
+    */
+   SolutionEnumerator(int numThreads, unsigned long long limit);
+
+   /**
+    * enumerate
+    *
+    * this function finds the solutions of the puzzle and passes them to
+    * the sink. The order of the solutions depends on the threads.
+    * @param puzzle : the loaded puzzle, it is not changed
+    * @param sink : where solutions go, or NULL to only count them
+    * @param context : passed to every call of sink
+    * @return unsigned long long : number of solutions found
+    */
+   unsigned long long enumerate(Puzzle &puzzle, Sink sink, void *context);
+
+   /**
+    * seconds
+    *
+    * @return double : how long the last enumerate took
+    */
+   double seconds();
+
+   /**
+    * subproblems
+    *
+    * @return size_t : number of smaller puzzles the last search was
+    * split into
+    */
+   size_t subproblems();
+
+   /**
+    * limitReached
+    *
+    * @return true : if the last enumerate stopped because the puzzle has
+    * more solutions than the limit
+    */
+   bool limitReached();
+
+private:
+   // a partly filled grid with the values used in each row, col and box
+   struct State
+   {
+      // value of every square, 0 if empty
+      unsigned char grid[81];
+      // bit v is set if value v is used
+      unsigned short rows[9];
+      unsigned short cols[9];
+      unsigned short boxes[9];
+      // number of empty squares
+      int empty;
+   };
+
+   // what one thread keeps while searching
+   struct Worker
+   {
+      // solutions not yet passed to the sink, 81 characters each
+      vector<char> grids;
+      // number of solutions in grids
+      size_t buffered;
+      // solutions this thread reported
+      unsigned long long found;
+   };
+
+   // number of threads searching
+   int numThreads;
+
+   // most solutions to find, 0 for no limit
+   unsigned long long limit;
+
+   // smaller puzzles the search was split into
+   vector<State> frontier;
+
+   // next entry of frontier to search
+   atomic<size_t> nextProblem;
+
+   // solutions found by all threads, only kept when there is a limit
+   atomic<unsigned long long> total;
+
+   // set once a solution past the limit has turned up
+   atomic<bool> stopping;
+
+   // sink of the current enumerate and its context
+   Sink sink;
+   void *context;
+
+   // makes calls to the sink one at a time
+   mutex sinkLock;
+
+   // time taken by the last enumerate
+   double elapsed;
+
+   /**
+    * place
+    *
+    * this function puts a value in an empty square of a state
+    * @param state : the state to change
+    * @param square : row * 9 + col of the square
+    * @param value : value 1-9
+    */
+   static void place(State &state, int square, int value);
+
+   /**
+    * unplace
+    *
+    * this function empties a square that place filled
+    * @param state : the state to change
+    * @param square : row * 9 + col of the square
+    * @param value : value the square holds
+    */
+   static void unplace(State &state, int square, int value);
+
+   /**
+    * bestSquare
+    *
+    * this function finds the empty square with the fewest values left
+    * @param state : the state to look at
+    * @param candidates : set to the bit mask of values left for it
+    * @return int : the square, or -1 if there are no empty squares
+    */
+   static int bestSquare(const State &state, unsigned short &candidates);
+
+   /**
+    * split
+    *
+    * this function fills frontier with smaller puzzles that together have
+    * the same solutions as start
+    * @param start : the puzzle as loaded
+    */
+   void split(const State &start);
+
+   /**
+    * run
+    *
+    * this function is run by every thread. It searches frontier entries
+    * until there are none left or the limit is passed.
+    * @param worker : the calling thread's buffers and counters
+    */
+   void run(Worker *worker);
+
+   /**
+    * search
+    *
+    * this function finds every solution of a state, depth first
+    * @param state : the state to search, it is restored afterwards
+    * @param worker : the calling thread's buffers and counters
+    * @return true : to keep searching, false once the limit was passed
+    */
+   bool search(State &state, Worker &worker);
+
+   /**
+    * report
+    *
+    * this function records one solution, unless it is past the limit
+    * @param state : a full grid
+    * @param worker : the calling thread's buffers and counters
+    * @return true : to keep searching, false once the limit was passed
+    */
+   bool report(const State &state, Worker &worker);
+
+   /**
+    * flush
+    *
+    * this function passes the solutions a thread has buffered to the sink
+    * @param worker : the calling thread's buffers
+    */
+   void flush(Worker &worker);
+};
+#endif
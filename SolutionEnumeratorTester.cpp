@@ -0,0 +1,161 @@
+/**
+ * @file SolutionEnumeratorTester.cpp
+ * @author Katarina McGaughy
+ * @brief SolutionEnumeratorTester performs tests on the SolutionEnumerator
+ * class by counting the solutions of puzzles whose counts are known, with
+ * and without a limit and with one and several threads
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "Puzzle.h"
+#include "SolutionEnumerator.h"
+#include <iostream>
+using namespace std;
+
+// what the sink saw
+struct Checked
+{
+   // the puzzle every solution must agree with
+   const char *puzzle;
+   // solutions passed to the sink
+   unsigned long long count;
+   // solutions that broke a rule or changed a given
+   unsigned long long bad;
+};
+
+/**
+ * check
+ *
+ * the sink for SolutionEnumerator: checks that every solution is a full
+ * grid that keeps the givens of the puzzle
+ * @param grids : count solutions of 81 characters
+ * @param count : number of solutions in grids
+ * @param context : the Checked to fill in
+ */
+static void check(const char *grids, size_t count, void *context)
+{
+   Checked *checked = (Checked *)context;
+   for (size_t i = 0; i < count; i++)
+   {
+      const char *grid = grids + i * 81;
+      // bit v of a row, column or box is set once value v was seen in it
+      int rows[9] = {0};
+      int cols[9] = {0};
+      int boxes[9] = {0};
+      bool good = true;
+      for (int square = 0; square < 81; square++)
+      {
+         char given = checked->puzzle[square];
+         int value = grid[square] - '0';
+         int row = square / 9;
+         int col = square % 9;
+         int box = row / 3 * 3 + col / 3;
+         good = good && value >= 1 && value <= 9 &&
+                (given == '0' || given == '.' || given == grid[square]);
+         rows[row] |= 1 << value;
+         cols[col] |= 1 << value;
+         boxes[box] |= 1 << value;
+      }
+      for (int unit = 0; unit < 9; unit++)
+      {
+         // every value 1-9 once
+         good = good && rows[unit] == 0x3FE && cols[unit] == 0x3FE &&
+                boxes[unit] == 0x3FE;
+      }
+      checked->count++;
+      checked->bad += !good;
+   }
+}
+
+/**
+ * enumerate
+ *
+ * this function counts the solutions of a puzzle and checks every one
+ * @param puzzleText : the 81 character puzzle
+ * @param numThreads : number of threads searching
+ * @param limit : most solutions to find, 0 for all of them
+ * @param limitReached : set to whether the search stopped at the limit
+ * @return unsigned long long : solutions found, or -1 if the sink saw a
+ * different number or a bad solution
+ */
+static unsigned long long enumerate(const char *puzzleText, int numThreads,
+                                    unsigned long long limit,
+                                    bool &limitReached)
+{
+   Puzzle puzzle;
+   puzzle.load(puzzleText);
+   Checked checked = {puzzleText, 0, 0};
+   SolutionEnumerator enumerator(numThreads, limit);
+   unsigned long long found = enumerator.enumerate(puzzle, check, &checked);
+   limitReached = enumerator.limitReached();
+   if (checked.count != found || checked.bad != 0)
+   {
+      return (unsigned long long)-1;
+   }
+   return found;
+}
+
+int main()
+{
+   // a solved grid with a swappable rectangle of four squares cleared
+   const char *twoSolutions =
+       "534678912672195348198342567859760420426850790713924856961537284287419635345286179";
+   // the same grid with its first four rows cleared
+   const char *manySolutions =
+       "000000000000000000000000000000000000426853791713924856961537284287419635345286179";
+   const unsigned long long manyCount = 1224;
+   // two 5s in the first row
+   const char *clashing =
+       "550070000600195000098000060800060003400803001700020006060000280000419005000080079";
+   int failures = 0;
+   bool limitReached;
+
+   if (enumerate(twoSolutions, 1, 0, limitReached) != 2 || limitReached)
+   {
+      cout << "The two solution puzzle did not give 2 solutions." << endl;
+      failures++;
+   }
+
+   // reaching the limit only counts when there are more solutions
+   if (enumerate(twoSolutions, 1, 2, limitReached) != 2 || limitReached)
+   {
+      cout << "A limit equal to the solution count was reported as reached."
+           << endl;
+      failures++;
+   }
+   if (enumerate(twoSolutions, 1, 1, limitReached) != 1 || !limitReached)
+   {
+      cout << "A limit below the solution count was not reported as reached."
+           << endl;
+      failures++;
+   }
+   if (enumerate(manySolutions, 4, 100, limitReached) != 100 || !limitReached)
+   {
+      cout << "Four threads did not stop at exactly the limit." << endl;
+      failures++;
+   }
+
+   if (enumerate(clashing, 1, 0, limitReached) != 0)
+   {
+      cout << "A puzzle with clashing givens had solutions." << endl;
+      failures++;
+   }
+
+   unsigned long long oneThread = enumerate(manySolutions, 1, 0, limitReached);
+   unsigned long long fourThreads = enumerate(manySolutions, 4, 0, limitReached);
+   if (oneThread != manyCount || fourThreads != manyCount)
+   {
+      cout << "Expected " << manyCount << " solutions, found " << oneThread
+           << " with 1 thread and " << fourThreads << " with 4." << endl;
+      failures++;
+   }
+
+   if (failures == 0)
+   {
+      cout << "All SolutionEnumerator tests passed." << endl;
+   }
+   return failures == 0 ? 0 : 1;
+}
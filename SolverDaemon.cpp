@@ -0,0 +1,59 @@
+/**
+ * @file SolverDaemon.cpp
+ * @author Katarina McGaughy
+ * @brief SolverDaemon runs the sudoku solver as a long running local
+ * server so other programs can send it puzzles over a Unix domain socket
+ * instead of starting a new process for every puzzle.
+ *
+ * usage: SolverDaemon [socket path] [workers] [max batch]
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "SolverServer.h"
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+using namespace std;
+
+// server stopped by the signal handler
+static SolverServer *running = NULL;
+
+/**
+ * handleSignal
+ *
+ * stops the server on SIGINT or SIGTERM so the socket file is removed
+ */
+static void handleSignal(int)
+{
+   if (running != NULL)
+   {
+      running->stop();
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   string socketPath = argc > 1 ? argv[1] : "/tmp/sudoku.sock";
+   int workers = argc > 2 ? atoi(argv[2]) : (int)thread::hardware_concurrency();
+   int maxBatch = argc > 3 ? atoi(argv[3]) : 64;
+
+   SolverServer server(socketPath, workers, maxBatch);
+   if (!server.start())
+   {
+      cerr << "Could not start the solver daemon." << endl;
+      return 1;
+   }
+   running = &server;
+   signal(SIGINT, handleSignal);
+   signal(SIGTERM, handleSignal);
+
+   cout << "Solving puzzles on " << socketPath << endl;
+   server.run();
+   cout << server.statsLine() << endl;
+   running = NULL;
+   return 0;
+}
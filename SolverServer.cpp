@@ -0,0 +1,641 @@
+/**
+ * @file SolverServer.cpp
+ * @author Katarina McGaughy
+ * @brief The SolverServer class keeps the sudoku solver running as a local
+ * daemon on a Unix domain socket. Puzzles from all connections are put on a
+ * shared queue and a pool of worker threads takes them off in batches.
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "SolverServer.h"
+#include "Puzzle.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+using namespace std;
+
+// longest line accepted before the connection is dropped
+static const size_t MAX_LINE = 4096;
+
+/**
+ * validPuzzle
+ *
+ * this function checks that a puzzle line only holds digits or '.'
+ * @param line : the 81 characters of the puzzle
+ * @return true : if every character can be loaded into a Puzzle
+ */
+static bool validPuzzle(const char *line)
+{
+   for (int i = 0; i < 81; i++)
+   {
+      if (line[i] != '.' && (line[i] < '0' || line[i] > '9'))
+      {
+         return false;
+      }
+   }
+   return true;
+}
+
+/**
+ * SolverServer
+ *
+ * constructor, nothing is opened until start is called
+ * @param socketPath : file system path of the Unix domain socket
+ * @param numWorkers : number of solver threads in the pool
+ * @param maxBatch : most requests a worker takes off the queue at once
+ */
+SolverServer::SolverServer(const string &socketPath, int numWorkers,
+                           int maxBatch)
+    : socketPath(socketPath), numWorkers(numWorkers < 1 ? 1 : numWorkers),
+      maxBatch(maxBatch < 1 ? 1 : maxBatch), listenFd(-1), stopping(false),
+      openConnections(0), requests(0), batches(0), solved(0), unsolvable(0),
+      rejected(0), totalLatencyMicros(0), maxLatencyMicros(0)
+{
+   for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+   {
+      latencyHistogram[bucket] = 0;
+   }
+}
+
+/**
+ * ~SolverServer
+ *
+ * destructor, stops the server and removes the socket file
+ */
+SolverServer::~SolverServer()
+{
+   stop();
+   {
+      lock_guard<mutex> lock(queueLock);
+   }
+   queueReady.notify_all();
+   for (size_t i = 0; i < workers.size(); i++)
+   {
+      if (workers[i].joinable())
+      {
+         workers[i].join();
+      }
+   }
+   if (listenFd >= 0)
+   {
+      close(listenFd);
+      unlink(socketPath.c_str());
+   }
+}
+
+/**
+ * start
+ *
+ * this function binds and listens on the socket and starts the
+ * worker threads
+ * @return true : if the server is ready to accept connections
+ * @return false : if the socket could not be opened
+ */
+bool SolverServer::start()
+{
+   sockaddr_un address;
+   memset(&address, 0, sizeof(address));
+   address.sun_family = AF_UNIX;
+   if (socketPath.length() >= sizeof(address.sun_path))
+   {
+      cerr << "Socket path is too long: " << socketPath << endl;
+      return false;
+   }
+   strcpy(address.sun_path, socketPath.c_str());
+
+   listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (listenFd < 0)
+   {
+      perror("socket");
+      return false;
+   }
+   // a socket file left behind by an earlier run would make bind fail
+   unlink(socketPath.c_str());
+   if (bind(listenFd, (sockaddr *)&address, sizeof(address)) < 0 ||
+       listen(listenFd, 128) < 0)
+   {
+      perror("bind");
+      close(listenFd);
+      listenFd = -1;
+      return false;
+   }
+
+   for (int i = 0; i < numWorkers; i++)
+   {
+      workers.push_back(thread(&SolverServer::workerLoop, this));
+   }
+   return true;
+}
+
+/**
+ * run
+ *
+ * this function accepts connections until stop is called. Every
+ * connection is served on its own thread. Before returning, the queue is
+ * drained, the workers are joined and every open connection is closed.
+ */
+void SolverServer::run()
+{
+   vector<int> clients;
+   mutex clientsLock;
+
+   while (!stopping)
+   {
+      int fd = accept(listenFd, NULL, NULL);
+      if (fd < 0)
+      {
+         if (stopping || errno == EINTR || errno == ECONNABORTED)
+         {
+            continue;
+         }
+         // out of descriptors or memory: wait for connections to close
+         // instead of spinning on the same error
+         perror("accept");
+         this_thread::sleep_for(chrono::milliseconds(100));
+         continue;
+      }
+      {
+         lock_guard<mutex> lock(clientsLock);
+         clients.push_back(fd);
+      }
+      openConnections++;
+      thread([this, fd, &clients, &clientsLock]() {
+         serveConnection(fd);
+         {
+            lock_guard<mutex> lock(clientsLock);
+            for (size_t i = 0; i < clients.size(); i++)
+            {
+               if (clients[i] == fd)
+               {
+                  clients.erase(clients.begin() + i);
+                  break;
+               }
+            }
+         }
+         close(fd);
+         openConnections--;
+      }).detach();
+   }
+
+   // workers finish whatever is queued before they exit
+   {
+      lock_guard<mutex> lock(queueLock);
+   }
+   queueReady.notify_all();
+   for (size_t i = 0; i < workers.size(); i++)
+   {
+      workers[i].join();
+   }
+   workers.clear();
+
+   // wake up connections blocked in read so their threads can exit
+   while (openConnections > 0)
+   {
+      {
+         lock_guard<mutex> lock(clientsLock);
+         for (size_t i = 0; i < clients.size(); i++)
+         {
+            shutdown(clients[i], SHUT_RDWR);
+         }
+      }
+      this_thread::sleep_for(chrono::milliseconds(1));
+   }
+}
+
+/**
+ * stop
+ *
+ * this function makes run return and shuts down the worker threads.
+ * Only async signal safe calls are made so it may be used from a
+ * signal handler.
+ */
+void SolverServer::stop()
+{
+   stopping = true;
+   if (listenFd >= 0)
+   {
+      shutdown(listenFd, SHUT_RDWR);
+   }
+}
+
+/**
+ * statsLine
+ *
+ * this function returns the throughput and latency counters formatted
+ * as the reply to a STATS request
+ * @return string : counters as name=value pairs without a newline
+ */
+string SolverServer::statsLine()
+{
+   long long finished = solved + unsolvable;
+   long long batchCount = batches;
+   char line[512];
+   snprintf(line, sizeof(line),
+            "STATS requests=%lld batches=%lld solved=%lld unsolvable=%lld "
+            "rejected=%lld avg_batch=%.2f avg_us=%lld p50_us=%lld "
+            "p99_us=%lld max_us=%lld connections=%d",
+            (long long)requests, batchCount, (long long)solved,
+            (long long)unsolvable, (long long)rejected,
+            batchCount ? (double)finished / batchCount : 0.0,
+            finished ? (long long)totalLatencyMicros / finished : 0LL,
+            latencyPercentile(50), latencyPercentile(99),
+            (long long)maxLatencyMicros, (int)openConnections);
+   return line;
+}
+
+/**
+ * workerLoop
+ *
+ * this function is run by every worker thread. It waits for requests,
+ * takes its share of them, at most maxBatch, and solves each with one
+ * reused Puzzle. Every request is marked done as soon as it is solved.
+ */
+void SolverServer::workerLoop()
+{
+   Puzzle puzzle;
+   vector<Request *> batch;
+   batch.reserve(maxBatch);
+
+   while (true)
+   {
+      unique_lock<mutex> lock(queueLock);
+      queueReady.wait(lock, [this]() { return stopping || !queue.empty(); });
+      if (queue.empty())
+      {
+         return; // stopping and nothing left to solve
+      }
+      // share what is queued among the workers instead of letting the
+      // first one to wake up take all of it
+      size_t share = (queue.size() + numWorkers - 1) / numWorkers;
+      share = min(share, (size_t)maxBatch);
+      while (batch.size() < share)
+      {
+         batch.push_back(queue.front());
+         queue.pop_front();
+      }
+      lock.unlock();
+
+      for (size_t i = 0; i < batch.size(); i++)
+      {
+         Request *request = batch[i];
+         if (puzzle.load(request->puzzle) && puzzle.Solve())
+         {
+            puzzle.write(request->answer);
+            request->solved = true;
+            solved++;
+         }
+         else
+         {
+            request->solved = false;
+            unsolvable++;
+         }
+         recordLatency(nowMicros() - request->queuedAt);
+
+         lock.lock();
+         request->done = true;
+         lock.unlock();
+         requestDone.notify_all();
+      }
+      batches++;
+      batch.clear();
+   }
+}
+
+/**
+ * serveConnection
+ *
+ * this function reads lines from one client, submits every puzzle that
+ * arrived in the same read as one group and writes each answer back as
+ * soon as it and the answers to all earlier lines are ready
+ * @param fd : socket of the client
+ */
+void SolverServer::serveConnection(int fd)
+{
+   string buffer;
+   string reply;
+   vector<Request> slots;
+   vector<Request *> pending;
+   // for every line read: index into slots, or -1 if replies holds the answer
+   vector<int> order;
+   vector<string> replies;
+   char chunk[8192];
+   bool quit = false;
+
+   while (!quit)
+   {
+      ssize_t count = read(fd, chunk, sizeof(chunk));
+      if (count <= 0)
+      {
+         return;
+      }
+      buffer.append(chunk, count);
+
+      // split everything that arrived into complete lines
+      size_t start = 0;
+      size_t newline;
+      order.clear();
+      replies.clear();
+      slots.clear();
+      while ((newline = buffer.find('\n', start)) != string::npos)
+      {
+         size_t length = newline - start;
+         if (length > 0 && buffer[newline - 1] == '\r')
+         {
+            length--;
+         }
+         const char *line = buffer.data() + start;
+         start = newline + 1;
+
+         if (length == 0)
+         {
+            continue;
+         }
+         if (length == 81 && !validPuzzle(line))
+         {
+            order.push_back(-1);
+            rejected++;
+            replies.push_back("ERROR expected digits or '.'");
+            continue;
+         }
+         if (length == 81)
+         {
+            Request request;
+            memcpy(request.puzzle, line, 81);
+            request.valid = true;
+            request.solved = false;
+            request.done = false;
+            order.push_back((int)slots.size());
+            slots.push_back(request);
+            requests++;
+            continue;
+         }
+
+         string command(line, length);
+         order.push_back(-1);
+         if (command == "STATS")
+         {
+            replies.push_back(statsLine());
+         }
+         else if (command == "QUIT")
+         {
+            quit = true;
+            order.pop_back();
+            break;
+         }
+         else
+         {
+            rejected++;
+            replies.push_back("ERROR expected 81 characters");
+         }
+      }
+      buffer.erase(0, start);
+      if (buffer.length() > MAX_LINE)
+      {
+         const char *tooLong = "ERROR line too long\n";
+         send(fd, tooLong, strlen(tooLong), MSG_NOSIGNAL);
+         return;
+      }
+
+      // slots is not resized from here on, so pointers into it stay valid
+      pending.clear();
+      for (size_t i = 0; i < slots.size(); i++)
+      {
+         pending.push_back(&slots[i]);
+      }
+      if (!pending.empty())
+      {
+         submit(pending);
+      }
+
+      size_t line = 0;
+      size_t nextReply = 0;
+      while (line < order.size())
+      {
+         size_t ready = waitForReplies(order, slots, line);
+         reply.clear();
+         for (; line < ready; line++)
+         {
+            if (order[line] < 0)
+            {
+               reply += replies[nextReply++];
+            }
+            else if (!slots[order[line]].valid)
+            {
+               reply += "ERROR server is shutting down";
+            }
+            else if (slots[order[line]].solved)
+            {
+               reply.append(slots[order[line]].answer, 81);
+            }
+            else
+            {
+               reply += "UNSOLVABLE";
+            }
+            reply += '\n';
+         }
+         if (!sendAll(fd, reply))
+         {
+            // the workers still point into slots until they are done
+            while (line < order.size())
+            {
+               line = waitForReplies(order, slots, line);
+            }
+            return;
+         }
+      }
+   }
+}
+
+/**
+ * waitForReplies
+ *
+ * this function waits until the answer to one line is ready
+ * @param order : for every line, index into slots or -1 if the answer
+ * does not need a worker
+ * @param slots : the requests of the lines
+ * @param first : the line to wait for
+ * @return size_t : one past the last line, from first on, whose answer
+ * and every earlier answer are ready
+ */
+size_t SolverServer::waitForReplies(const vector<int> &order,
+                                    const vector<Request> &slots, size_t first)
+{
+   unique_lock<mutex> lock(queueLock);
+   requestDone.wait(lock, [&]() {
+      return order[first] < 0 || slots[order[first]].done;
+   });
+   size_t ready = first + 1;
+   while (ready < order.size() &&
+          (order[ready] < 0 || slots[order[ready]].done))
+   {
+      ready++;
+   }
+   return ready;
+}
+
+/**
+ * sendAll
+ *
+ * @param fd : socket of the client
+ * @param data : bytes to send
+ * @return true : if everything was sent
+ */
+bool SolverServer::sendAll(int fd, const string &data)
+{
+   size_t sent = 0;
+   while (sent < data.length())
+   {
+      ssize_t wrote = send(fd, data.data() + sent, data.length() - sent,
+                           MSG_NOSIGNAL);
+      if (wrote <= 0)
+      {
+         return false;
+      }
+      sent += wrote;
+   }
+   return true;
+}
+
+/**
+ * submit
+ *
+ * this function queues requests for the workers. If the server is
+ * stopping the requests are marked invalid and done instead.
+ * @param pending : requests to solve
+ */
+void SolverServer::submit(vector<Request *> &pending)
+{
+   unique_lock<mutex> lock(queueLock);
+   if (stopping)
+   {
+      for (size_t i = 0; i < pending.size(); i++)
+      {
+         pending[i]->valid = false;
+         pending[i]->done = true;
+      }
+      return;
+   }
+   long long now = nowMicros();
+   for (size_t i = 0; i < pending.size(); i++)
+   {
+      pending[i]->queuedAt = now;
+      queue.push_back(pending[i]);
+   }
+   if (pending.size() == 1)
+   {
+      queueReady.notify_one();
+   }
+   else
+   {
+      queueReady.notify_all();
+   }
+}
+
+/**
+ * recordLatency
+ *
+ * this function adds one finished request to the latency counters
+ * @param micros : time from being queued to being solved
+ */
+void SolverServer::recordLatency(long long micros)
+{
+   totalLatencyMicros += micros;
+   long long seen = maxLatencyMicros;
+   while (micros > seen && !maxLatencyMicros.compare_exchange_weak(seen, micros))
+   {
+   }
+   latencyHistogram[latencyBucket(micros)]++;
+}
+
+/**
+ * latencyPercentile
+ *
+ * this function estimates a latency percentile from the histogram. The
+ * answer is at most one eighth too high, and never more than the largest
+ * latency seen.
+ * @param percent : percentile between 0 and 100
+ * @return long long : upper bound of the bucket in microseconds
+ */
+long long SolverServer::latencyPercentile(double percent)
+{
+   long long total = 0;
+   for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+   {
+      total += latencyHistogram[bucket];
+   }
+   if (total == 0)
+   {
+      return 0;
+   }
+   long long wanted = (long long)(total * percent / 100.0 + 0.5);
+   long long seen = 0;
+   for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+   {
+      seen += latencyHistogram[bucket];
+      if (seen >= wanted)
+      {
+         return min(latencyBucketTop(bucket), (long long)maxLatencyMicros);
+      }
+   }
+   return maxLatencyMicros;
+}
+
+/**
+ * latencyBucket
+ *
+ * this function finds the histogram bucket of a latency. Latencies below
+ * LATENCY_STEPS get a bucket each; above that every power of two is split
+ * into LATENCY_STEPS equal buckets.
+ * @param micros : a latency
+ * @return int : the histogram bucket the latency is counted in
+ */
+int SolverServer::latencyBucket(long long micros)
+{
+   if (micros < LATENCY_STEPS)
+   {
+      return micros < 0 ? 0 : (int)micros;
+   }
+   int power = 63 - __builtin_clzll((unsigned long long)micros);
+   int shift = power - 3; // LATENCY_STEPS is 2^3
+   int step = (int)((micros >> shift) - LATENCY_STEPS);
+   int bucket = LATENCY_STEPS + shift * LATENCY_STEPS + step;
+   return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+}
+
+/**
+ * latencyBucketTop
+ *
+ * @param bucket : a histogram bucket
+ * @return long long : the largest latency counted in the bucket
+ */
+long long SolverServer::latencyBucketTop(int bucket)
+{
+   if (bucket < LATENCY_STEPS)
+   {
+      return bucket;
+   }
+   int shift = (bucket - LATENCY_STEPS) / LATENCY_STEPS;
+   int step = (bucket - LATENCY_STEPS) % LATENCY_STEPS;
+   return ((long long)(LATENCY_STEPS + step + 1) << shift) - 1;
+}
+
+/**
+ * nowMicros
+ *
+ * @return long long : microseconds on a monotonic clock
+ */
+long long SolverServer::nowMicros()
+{
+   return chrono::duration_cast<chrono::microseconds>(
+              chrono::steady_clock::now().time_since_epoch())
+       .count();
+}
@@ -0,0 +1,249 @@
+/**
+ * @file SolverServer.h
+ * @author Katarina McGaughy
+ * @brief The SolverServer class keeps the sudoku solver running as a local
+ * daemon on a Unix domain socket. Clients send one puzzle per line and get
+ * one answer per line back. Puzzles from all connections are put on a
+ * shared queue and a pool of worker threads takes them off in batches, so
+ * each worker reuses the same Puzzle object for many requests. A worker
+ * only takes its share of the queue, so a burst of puzzles is spread over
+ * the pool, and every answer is sent as soon as the answers before it on
+ * its connection are.
+ *
+ * Protocol (one line each way, newline terminated):
+ *    81 characters, '0' or '.' for empty -> 81 character solved grid
+ *                                        -> UNSOLVABLE
+ *                                        -> ERROR <reason>
+ *    STATS                               -> STATS <name>=<value> ...
+ *    QUIT                                -> connection is closed
+ * A client may send many lines before reading the answers; answers always
+ * come back in the order the lines were sent.
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef SOLVERSERVER
+#define SOLVERSERVER
+using namespace std;
+
+class SolverServer
+{
+
+public:
+   /**
+    * SolverServer
+    *
+    * constructor, nothing is opened until start is called
+    * @param socketPath : file system path of the Unix domain socket
+    * @param numWorkers : number of solver threads in the pool
+    * @param maxBatch : most requests a worker takes off the queue at once
+    */
+   SolverServer(const string &socketPath, int numWorkers, int maxBatch);
+
+   /**
+    * ~SolverServer
+    *
+    * destructor, stops the server and removes the socket file
+    */
+   ~SolverServer();
+
+   /**
+    * start
+    *
+    * this function binds and listens on the socket and starts the
+    * worker threads
+    * @return true : if the server is ready to accept connections
+    * @return false : if the socket could not be opened
+    */
+   bool start();
+
+   /**
+    * run
+    *
+    * this function accepts connections until stop is called. Every
+    * connection is served on its own thread.
+    */
+   void run();
+
+   /**
+    * stop
+    *
+    * this function makes run return and shuts down the worker threads.
+    * Only async signal safe calls are made so it may be used from a
+    * signal handler.
+    */
+   void stop();
+
+   /**
+    * statsLine
+    *
+    * this function returns the throughput and latency counters formatted
+    * as the reply to a STATS request
+    * @return string : counters as name=value pairs without a newline
+    */
+   string statsLine();
+
+private:
+   // one puzzle waiting for, or finished by, a worker
+   struct Request
+   {
+      char puzzle[81];
+      char answer[81];
+      bool valid;
+      bool solved;
+      bool done;
+      long long queuedAt;
+   };
+
+   // every power of two of microseconds is split into this many buckets
+   static const int LATENCY_STEPS = 8;
+
+   // number of latency buckets: 0-7 us one each, then LATENCY_STEPS per
+   // power of two up to 2^43 us
+   static const int LATENCY_BUCKETS = LATENCY_STEPS + 40 * LATENCY_STEPS;
+
+   // path of the socket file
+   string socketPath;
+
+   // number of solver threads
+   int numWorkers;
+
+   // most requests one worker takes off the queue at once
+   int maxBatch;
+
+   // listening socket, -1 when closed
+   int listenFd;
+
+   // set once stop has been called
+   atomic<bool> stopping;
+
+   // solver threads
+   vector<thread> workers;
+
+   // requests waiting for a worker
+   deque<Request *> queue;
+
+   // guards queue and the done flags of requests
+   mutex queueLock;
+
+   // signalled when requests are queued
+   condition_variable queueReady;
+
+   // signalled when a request is done
+   condition_variable requestDone;
+
+   // number of connections currently being served
+   atomic<int> openConnections;
+
+   // counters reported by STATS
+   atomic<long long> requests;
+   atomic<long long> batches;
+   atomic<long long> solved;
+   atomic<long long> unsolvable;
+   atomic<long long> rejected;
+   atomic<long long> totalLatencyMicros;
+   atomic<long long> maxLatencyMicros;
+   atomic<long long> latencyHistogram[LATENCY_BUCKETS];
+
+   /**
+    * workerLoop
+    *
+    * this function is run by every worker thread. It waits for requests,
+    * takes its share of the queue, at most maxBatch, and solves each with
+    * one reused Puzzle.
+    */
+   void workerLoop();
+
+   /**
+    * serveConnection
+    *
+    * this function reads lines from one client, submits every puzzle that
+    * arrived in the same read as one group and writes each answer back as
+    * soon as it and the answers to all earlier lines are ready
+    * @param fd : socket of the client
+    */
+   void serveConnection(int fd);
+
+   /**
+    * submit
+    *
+    * this function queues requests for the workers without waiting for
+    * them
+    * @param pending : requests to solve
+    */
+   void submit(vector<Request *> &pending);
+
+   /**
+    * waitForReplies
+    *
+    * this function waits until the answer to one line is ready
+    * @param order : for every line, index into slots or -1 if the answer
+    * does not need a worker
+    * @param slots : the requests of the lines
+    * @param first : the line to wait for
+    * @return size_t : one past the last line, from first on, whose answer
+    * and every earlier answer are ready
+    */
+   size_t waitForReplies(const vector<int> &order,
+                         const vector<Request> &slots, size_t first);
+
+   /**
+    * sendAll
+    *
+    * @param fd : socket of the client
+    * @param data : bytes to send
+    * @return true : if everything was sent
+    */
+   static bool sendAll(int fd, const string &data);
+
+   /**
+    * recordLatency
+    *
+    * this function adds one finished request to the latency counters
+    * @param micros : time from being queued to being solved
+    */
+   void recordLatency(long long micros);
+
+   /**
+    * latencyPercentile
+    *
+    * this function estimates a latency percentile from the histogram
+    * @param percent : percentile between 0 and 100
+    * @return long long : upper bound of the bucket in microseconds, never
+    * more than the largest latency seen
+    */
+   long long latencyPercentile(double percent);
+
+   /**
+    * latencyBucket
+    *
+    * @param micros : a latency
+    * @return int : the histogram bucket the latency is counted in
+    */
+   static int latencyBucket(long long micros);
+
+   /**
+    * latencyBucketTop
+    *
+    * @param bucket : a histogram bucket
+    * @return long long : the largest latency counted in the bucket
+    */
+   static long long latencyBucketTop(int bucket);
+
+   /**
+    * nowMicros
+    *
+    * @return long long : microseconds on a monotonic clock
+    */
+   static long long nowMicros();
+};
+#endif
@@ -0,0 +1,443 @@
+/**
+ * @file Trace.cpp
+ * @author Katarina McGaughy
+ * @brief The Trace class records how long the solver spends in each of its
+ * phases. Every thread keeps a ring buffer of its latest events for the
+ * Chrome trace JSON, and a call tree of total time and calls per stack of
+ * phases, which never drops anything, for the folded stacks.
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include "Trace.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+using namespace std;
+
+// one timed phase
+struct TraceEvent
+{
+   const char *name;
+   long long begin;
+   long long end;
+};
+
+// totals for one stack of phases, a node of a thread's call tree
+struct TraceNode
+{
+   const char *name;
+   // index of the enclosing phase's node, -1 at the top
+   int parent;
+   // time spent in the phase, including its children
+   long long total;
+   // time spent in the phases directly inside it
+   long long children;
+   // number of times the phase ran
+   unsigned long long calls;
+};
+
+// most call tree nodes per thread; phases that would need more are only
+// kept in the ring buffer
+static const size_t MAX_NODES = 1024;
+
+// the ring buffer and call tree of one thread
+struct TraceBuffer
+{
+   int thread;
+   vector<TraceEvent> events;
+   // slot the next event goes in
+   size_t next;
+   // events recorded, including the ones that were overwritten
+   unsigned long long recorded;
+   // call tree of the phases, never overwritten
+   vector<TraceNode> nodes;
+   // node of the innermost open phase, -1 if none is open
+   int open;
+   // phases open inside the innermost one because the tree was full
+   int overflowed;
+};
+
+// whether Scope records anything
+atomic<bool> Trace::recording(false);
+
+// events kept per thread for buffers created from now on
+static size_t capacity = 1 << 20;
+
+// every buffer ever created; they are kept after their thread exits so
+// the events can still be written out
+static vector<TraceBuffer *> buffers;
+static mutex buffersLock;
+
+// the calling thread's buffer, NULL until its first event
+static thread_local TraceBuffer *current = NULL;
+
+/**
+ * nowNanos
+ *
+ * @return long long : nanoseconds on a monotonic clock
+ */
+static long long nowNanos()
+{
+   return chrono::duration_cast<chrono::nanoseconds>(
+              chrono::steady_clock::now().time_since_epoch())
+       .count();
+}
+
+/**
+ * threadBuffer
+ *
+ * this function returns the calling thread's buffer, creating it on the
+ * first call
+ * @return TraceBuffer* : the buffer of the calling thread
+ */
+static TraceBuffer *threadBuffer()
+{
+   if (current == NULL)
+   {
+      lock_guard<mutex> lock(buffersLock);
+      current = new TraceBuffer;
+      current->thread = (int)buffers.size();
+      current->events.resize(capacity > 0 ? capacity : 1);
+      current->next = 0;
+      current->recorded = 0;
+      current->nodes.reserve(MAX_NODES);
+      current->open = -1;
+      current->overflowed = 0;
+      buffers.push_back(current);
+   }
+   return current;
+}
+
+/**
+ * enter
+ *
+ * this function finds or adds the call tree node of a phase inside the
+ * innermost open phase, and makes it the innermost open phase. If the
+ * tree is full the phase is only counted in overflowed.
+ * @param buffer : the calling thread's buffer
+ * @param name : name of the phase
+ */
+static void enter(TraceBuffer *buffer, const char *name)
+{
+   if (buffer->overflowed > 0)
+   {
+      buffer->overflowed++;
+      return;
+   }
+   int node = -1;
+   for (size_t i = 0; i < buffer->nodes.size(); i++)
+   {
+      if (buffer->nodes[i].parent == buffer->open &&
+          buffer->nodes[i].name == name)
+      {
+         node = (int)i;
+         break;
+      }
+   }
+   if (node < 0 && buffer->nodes.size() < MAX_NODES)
+   {
+      TraceNode added = {name, buffer->open, 0, 0, 0};
+      buffer->nodes.push_back(added);
+      node = (int)buffer->nodes.size() - 1;
+   }
+   if (node < 0)
+   {
+      buffer->overflowed = 1;
+      return;
+   }
+   buffer->open = node;
+}
+
+/**
+ * stackOf
+ *
+ * @param buffer : a thread's buffer
+ * @param node : a node of its call tree
+ * @return string : the names from the top phase down, joined by ';'
+ */
+static string stackOf(const TraceBuffer *buffer, int node)
+{
+   string stack = buffer->nodes[node].name;
+   for (int up = buffer->nodes[node].parent; up >= 0;
+        up = buffer->nodes[up].parent)
+   {
+      stack = string(buffer->nodes[up].name) + ";" + stack;
+   }
+   return stack;
+}
+
+/**
+ * inOrder
+ *
+ * this function copies a thread's events oldest first
+ * @param buffer : the ring buffer
+ * @param events : filled with the events still in the buffer
+ */
+static void inOrder(const TraceBuffer *buffer, vector<TraceEvent> &events)
+{
+   size_t size = buffer->events.size();
+   if (buffer->recorded <= size)
+   {
+      events.assign(buffer->events.begin(),
+                    buffer->events.begin() + (size_t)buffer->recorded);
+   }
+   else
+   {
+      events.assign(buffer->events.begin() + buffer->next, buffer->events.end());
+      events.insert(events.end(), buffer->events.begin(),
+                    buffer->events.begin() + buffer->next);
+   }
+}
+
+/**
+ * start
+ *
+ * this function opens the phase in the thread's totals
+ * @param name : name of the phase
+ * @return long long : the start time in nanoseconds
+ */
+long long Trace::Scope::start(const char *name)
+{
+   enter(threadBuffer(), name);
+   return nowNanos();
+}
+
+/**
+ * finish
+ *
+ * this function closes the innermost open phase in the thread's totals
+ * and adds it to the ring buffer. Phases nest, so the innermost open one
+ * is the one finishing.
+ * @param name : name of the phase
+ * @param begin : its start time in nanoseconds
+ */
+void Trace::Scope::finish(const char *name, long long begin)
+{
+   long long end = nowNanos();
+   TraceBuffer *buffer = threadBuffer();
+   if (buffer->overflowed > 0)
+   {
+      buffer->overflowed--;
+   }
+   else
+   {
+      TraceNode &phase = buffer->nodes[buffer->open];
+      phase.total += end - begin;
+      phase.calls++;
+      if (phase.parent >= 0)
+      {
+         buffer->nodes[phase.parent].children += end - begin;
+      }
+      buffer->open = phase.parent;
+   }
+   TraceEvent &event = buffer->events[buffer->next];
+   event.name = name;
+   event.begin = begin;
+   event.end = end;
+   buffer->next++;
+   if (buffer->next == buffer->events.size())
+   {
+      buffer->next = 0;
+   }
+   buffer->recorded++;
+}
+
+/**
+ * compiledIn
+ *
+ * @return true : if the program was built with -DSUDOKU_TRACE
+ */
+bool Trace::compiledIn()
+{
+#ifdef SUDOKU_TRACE
+   return true;
+#else
+   return false;
+#endif
+}
+
+/**
+ * setEnabled
+ *
+ * this function turns recording on or off for every thread
+ * @param on : true to record trace points
+ */
+void Trace::setEnabled(bool on)
+{
+   recording = on;
+}
+
+/**
+ * enabled
+ *
+ * @return true : if trace points are being recorded
+ */
+bool Trace::enabled()
+{
+   return recording;
+}
+
+/**
+ * setCapacity
+ *
+ * this function sets how many events each thread keeps
+ * @param events : number of events per thread
+ */
+void Trace::setCapacity(size_t events)
+{
+   lock_guard<mutex> lock(buffersLock);
+   capacity = events;
+}
+
+/**
+ * prepareThread
+ *
+ * this function creates the calling thread's buffer now instead of at
+ * its first event
+ */
+void Trace::prepareThread()
+{
+   if (recording)
+   {
+      threadBuffer();
+   }
+}
+
+/**
+ * droppedEvents
+ *
+ * @return unsigned long long : events overwritten in the ring buffers of
+ * all threads
+ */
+unsigned long long Trace::droppedEvents()
+{
+   lock_guard<mutex> lock(buffersLock);
+   unsigned long long dropped = 0;
+   for (size_t t = 0; t < buffers.size(); t++)
+   {
+      if (buffers[t]->recorded > buffers[t]->events.size())
+      {
+         dropped += buffers[t]->recorded - buffers[t]->events.size();
+      }
+   }
+   return dropped;
+}
+
+/**
+ * writeChromeJson
+ *
+ * this function writes the events of every thread in the Chrome trace
+ * event format. Times are in microseconds from the first event.
+ * PRE: the traced threads must have finished.
+ * @param path : file to write
+ * @return true : if the file was written
+ */
+bool Trace::writeChromeJson(const char *path)
+{
+   FILE *file = fopen(path, "w");
+   if (file == NULL)
+   {
+      return false;
+   }
+   lock_guard<mutex> lock(buffersLock);
+   vector<vector<TraceEvent> > threads(buffers.size());
+   long long start = -1;
+   for (size_t t = 0; t < buffers.size(); t++)
+   {
+      inOrder(buffers[t], threads[t]);
+      for (size_t i = 0; i < threads[t].size(); i++)
+      {
+         if (start < 0 || threads[t][i].begin < start)
+         {
+            start = threads[t][i].begin;
+         }
+      }
+   }
+
+   fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+   bool first = true;
+   for (size_t t = 0; t < threads.size(); t++)
+   {
+      for (size_t i = 0; i < threads[t].size(); i++)
+      {
+         const TraceEvent &event = threads[t][i];
+         fprintf(file,
+                 "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                 "\"ts\":%.3f,\"dur\":%.3f}",
+                 first ? "" : ",", event.name, buffers[t]->thread,
+                 (event.begin - start) / 1000.0,
+                 (event.end - event.begin) / 1000.0);
+         first = false;
+      }
+   }
+   // the ring buffers only keep the latest events, so the totals of the
+   // call trees are added for the time and calls of every stack
+   unsigned long long dropped = 0;
+   map<string, pair<long long, unsigned long long> > totals;
+   for (size_t t = 0; t < buffers.size(); t++)
+   {
+      dropped += buffers[t]->recorded - threads[t].size();
+      const vector<TraceNode> &nodes = buffers[t]->nodes;
+      for (size_t i = 0; i < nodes.size(); i++)
+      {
+         pair<long long, unsigned long long> &total =
+             totals[stackOf(buffers[t], (int)i)];
+         total.first += nodes[i].total;
+         total.second += nodes[i].calls;
+      }
+   }
+   fprintf(file, "\n],\n\"otherData\":{\"droppedEvents\":%llu", dropped);
+   for (map<string, pair<long long, unsigned long long> >::iterator it =
+            totals.begin();
+        it != totals.end(); ++it)
+   {
+      fprintf(file, ",\n\"%s\":\"%llu calls, %lld ns\"", it->first.c_str(),
+              it->second.second, it->second.first);
+   }
+   fprintf(file, "}}\n");
+   return fclose(file) == 0;
+}
+
+/**
+ * writeFolded
+ *
+ * this function writes the call trees of every thread as folded stacks.
+ * Each stack is weighted by the time spent in its innermost phase minus
+ * the time spent in the phases inside it. The call trees keep every
+ * phase, so the weights stay right after the ring buffers wrap.
+ * PRE: the traced threads must have finished.
+ * @param path : file to write
+ * @return true : if the file was written
+ */
+bool Trace::writeFolded(const char *path)
+{
+   FILE *file = fopen(path, "w");
+   if (file == NULL)
+   {
+      return false;
+   }
+   lock_guard<mutex> lock(buffersLock);
+   map<string, long long> selfTime;
+   for (size_t t = 0; t < buffers.size(); t++)
+   {
+      const vector<TraceNode> &nodes = buffers[t]->nodes;
+      for (size_t i = 0; i < nodes.size(); i++)
+      {
+         long long self = nodes[i].total - nodes[i].children;
+         selfTime[stackOf(buffers[t], (int)i)] += self > 0 ? self : 0;
+      }
+   }
+   for (map<string, long long>::iterator it = selfTime.begin();
+        it != selfTime.end(); ++it)
+   {
+      fprintf(file, "%s %lld\n", it->first.c_str(), it->second);
+   }
+   return fclose(file) == 0;
+}
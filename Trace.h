@@ -0,0 +1,184 @@
+/**
+ * @file Trace.h
+ * @author Katarina McGaughy
+ * @brief The Trace class records how long the solver spends in each of its
+ * phases. TRACE_SCOPE(name) times the enclosing block and stores it in a
+ * ring buffer owned by the current thread, and adds it to the thread's
+ * totals for the stack of phases it ran in, so threads never wait on each
+ * other while tracing. Recording only happens when the program was built
+ * with -DSUDOKU_TRACE and tracing was turned on with setEnabled; without
+ * -DSUDOKU_TRACE the macro expands to nothing and costs nothing. With it,
+ * a trace point that is not recording only checks the flag inline.
+ *
+ * The latest events can be written as Chrome trace JSON (chrome://tracing,
+ * Perfetto, speedscope), and the totals as folded stacks, the format
+ * flamegraph.pl reads from perf script output. The totals are never
+ * overwritten, so the folded stacks cover the whole run.
+ * @version 0.1
+ * @date 2021-11-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <atomic>
+#include <cstddef>
+#ifndef TRACE
+#define TRACE
+using namespace std;
+
+#ifdef SUDOKU_TRACE
+#define TRACE_JOIN(a, b) a##b
+#define TRACE_NAME(line) TRACE_JOIN(traceScope, line)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_NAME(__LINE__)(name)
+#else
+#define TRACE_SCOPE(name)
+#endif
+
+class Trace
+{
+
+public:
+   /**
+    * Scope
+    *
+    * times the block it is declared in and records it when the block ends
+    */
+   class Scope
+   {
+
+   public:
+      /**
+       * Scope
+       *
+       * constructor, remembers the start time if tracing is on. When it
+       * is off only the flag is read, so the check is kept inline.
+       * @param name : name of the phase, must be a string literal
+       */
+      Scope(const char *name) : name(name), begin(-1)
+      {
+         if (__builtin_expect(recording.load(memory_order_relaxed), 0))
+         {
+            begin = start(name);
+         }
+      }
+
+      /**
+       * ~Scope
+       *
+       * destructor, records the phase in the thread's ring buffer and
+       * totals if the constructor started timing it
+       */
+      ~Scope()
+      {
+         if (__builtin_expect(begin >= 0, 0))
+         {
+            finish(name, begin);
+         }
+      }
+
+   private:
+      // name of the phase
+      const char *name;
+      // start time in nanoseconds, -1 if tracing was off
+      long long begin;
+
+      // start and finish are static and kept out of line, so a scope
+      // that is not recording stays as small as the check of the flag
+
+      /**
+       * start
+       *
+       * this function opens the phase in the thread's totals
+       * @param name : name of the phase
+       * @return long long : the start time in nanoseconds
+       */
+      __attribute__((cold, noinline)) static long long start(const char *name);
+
+      /**
+       * finish
+       *
+       * this function closes the innermost open phase in the thread's
+       * totals and adds it to the ring buffer
+       * @param name : name of the phase
+       * @param begin : its start time in nanoseconds
+       */
+      __attribute__((cold, noinline)) static void finish(const char *name,
+                                                         long long begin);
+   };
+
+   /**
+    * compiledIn
+    *
+    * @return true : if the program was built with -DSUDOKU_TRACE, so
+    * TRACE_SCOPE records anything
+    */
+   static bool compiledIn();
+
+   /**
+    * setEnabled
+    *
+    * this function turns recording on or off for every thread
+    * @param on : true to record trace points
+    */
+   static void setEnabled(bool on);
+
+   /**
+    * enabled
+    *
+    * @return true : if trace points are being recorded
+    */
+   static bool enabled();
+
+   /**
+    * setCapacity
+    *
+    * this function sets how many events each thread keeps. Once a buffer
+    * is full the oldest events are overwritten. Only buffers created
+    * afterwards use the new capacity.
+    * @param events : number of events per thread
+    */
+   static void setCapacity(size_t events);
+
+   /**
+    * prepareThread
+    *
+    * this function creates the calling thread's buffer now instead of at
+    * its first event, so a loop that must not allocate can be traced
+    */
+   static void prepareThread();
+
+   /**
+    * writeChromeJson
+    *
+    * this function writes the events of every thread in the Chrome trace
+    * event format, with the number of dropped events and the totals of
+    * every stack under "otherData"
+    * @param path : file to write
+    * @return true : if the file was written
+    */
+   static bool writeChromeJson(const char *path);
+
+   /**
+    * writeFolded
+    *
+    * this function writes the totals of every thread as folded stacks,
+    * one "outer;inner <nanoseconds>" line per stack, weighted by the
+    * time spent in the innermost phase itself
+    * @param path : file to write
+    * @return true : if the file was written
+    */
+   static bool writeFolded(const char *path);
+
+   /**
+    * droppedEvents
+    *
+    * @return unsigned long long : number of events the ring buffers
+    * overwrote, which are missing from the Chrome trace JSON
+    */
+   static unsigned long long droppedEvents();
+
+private:
+   // true while trace points are being recorded
+   static atomic<bool> recording;
+};
+#endif